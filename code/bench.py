@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+# Benchmark of every -alg mode on a fixed instance suite, results as JSON
+#
+# The suite is generated from fixed seeds into bench/, more instances can be added with --inst file[:target]
+# Each instance is run with BnB, Approx, LS1 and LS2 for every seed and the same time budget, and each run reports:
+#	ran_as				- algorithm MinVC ran, LS1 for LS2 on a weighted graph
+#	load_s				- time MinVC took to read the graph
+#	wall_s				- time of the whole run
+#	peak_rss_kb			- peak resident set size of MinVC itself, null for a run that took under 20 ms and stayed smaller
+#						  than this script, which the 2 ms samples can not catch
+#	cover				- size of the cover, its weight if the graph is weighted
+#	time_to_target_s	- first time the trace reached the target of the instance, null if it never did
+#	nodes_per_s			- BnB search nodes per second
+#	steps_per_s			- LS1 exchanges or LS2 rounds per second
+# The target of an instance is the one given with --inst, or else the best cover any run found on it.
+# With --baseline the results are compared to an earlier JSON file, and the exit code is 1 if a rate or a
+# time to target got worse by more than --tolerance.
+
+import argparse
+import json
+import os
+import random
+import re
+import subprocess
+import sys
+import threading
+import time
+
+ALGS = [ "BnB", "Approx", "LS1", "LS2" ]
+
+
+def write_graph( path, n, edges, weights = None ):
+	adj = [ set() for _ in range( n ) ]
+	for u, v in edges:
+		if u != v:
+			adj[u].add( v )
+			adj[v].add( u )
+	m = sum( len( a ) for a in adj ) // 2
+	with open( path, "w" ) as f:
+		f.write( "%d %d %d\n" % ( n, m, 10 if weights else 0 ) )
+		for i, a in enumerate( adj ):
+			line = [ str( x + 1 ) for x in sorted( a ) ]
+			if weights:
+				line.insert( 0, str( weights[i] ) )
+			f.write( " ".join( line ) + "\n" )
+
+
+def random_edges( n, m, r ):
+	edges = set()
+	while len( edges ) < m:
+		u, v = r.randrange( n ), r.randrange( n )
+		if u != v:
+			edges.add( ( min( u, v ), max( u, v ) ) )
+	return list( edges )
+
+
+def grid_edges( side, r ):
+	edges = []
+	for i in range( side ):
+		for j in range( side ):
+			v = i * side + j
+			if j + 1 < side:
+				edges.append( ( v, v + 1 ) )
+			if i + 1 < side:
+				edges.append( ( v, v + side ) )
+			if i + 1 < side and j + 1 < side and r.random() < 0.5:
+				edges.append( ( v, v + side + 1 ) )
+	return edges
+
+
+def powerlaw_edges( n, k, r ):
+	ends, edges = [], []
+	for v in range( 1, n ):
+		for _ in range( min( v, k ) ):
+			u = r.choice( ends ) if ends and r.random() < 0.8 else r.randrange( v )
+			edges.append( ( v, u ) )
+			ends += [ v, u ]
+	return edges
+
+
+# name -> ( vertices, edges, weights ), all from fixed seeds
+def suite():
+	r = random.Random( 1 )
+	yield "random", 2000, random_edges( 2000, 6000, r ), None
+	r = random.Random( 2 )
+	yield "grid", 2500, grid_edges( 50, r ), None
+	r = random.Random( 3 )
+	yield "powerlaw", 5000, powerlaw_edges( 5000, 3, r ), None
+	r = random.Random( 4 )
+	yield "weighted", 1000, random_edges( 1000, 3000, r ), [ r.randint( 1, 10 ) for _ in range( 1000 ) ]
+	# Covers of a single vertex, which LS1 has to take apart and put back
+	yield "star", 4, [ ( 0, 1 ), ( 0, 2 ), ( 0, 3 ) ], None
+	yield "edge", 2, [ ( 0, 1 ) ], None
+
+
+def generate( folder ):
+	instances = []
+	for name, n, edges, weights in suite():
+		path = os.path.join( folder, name + ".graph" )
+		if not os.path.exists( path ):
+			write_graph( path, n, edges, weights )
+		instances.append( ( path, None ) )
+	return instances
+
+
+def first( pattern, text, cast = float ):
+	m = re.search( pattern, text )
+	return cast( m.group( 1 ) ) if m else None
+
+
+# VmHWM of a process in kB, None if there is no /proc, the process has exited or it does not run name (yet)
+def peak_rss( pid, name = None ):
+	try:
+		with open( "/proc/%d/status" % pid ) as f:
+			fields = dict( line.split( ":", 1 ) for line in f if ":" in line )
+	except OSError:
+		return None
+	# The kernel cuts names to 15 characters
+	if ( name is not None and fields.get( "Name", "" ).strip() != name[:15] ) or "VmHWM" not in fields:
+		return None
+	return int( fields["VmHWM"].split()[0] )
+
+
+# Runs one MinVC, returns the parsed stdout, wall time, peak RSS and exit code
+# On Linux ru_maxrss of the child also counts the forked Python from before the exec, so it is only the peak of
+# MinVC when it is above the peak of this process. Otherwise the peak is the largest VmHWM sampled while MinVC ran,
+# if it ran long enough for the samples to be worth anything.
+def run( binary, workdir, args ):
+	start = time.time()
+	p = subprocess.Popen( [ binary ] + args, cwd = workdir, stdout = subprocess.PIPE, stderr = subprocess.STDOUT )
+	chunks = []
+	reader = threading.Thread( target = lambda: chunks.append( p.stdout.read() ) )
+	reader.start()
+	sampled, name = None, os.path.basename( binary )
+	while True:
+		peak = peak_rss( p.pid, name )
+		sampled = peak if peak is not None else sampled
+		pid, status, usage = os.wait4( p.pid, os.WNOHANG )
+		if pid != 0:
+			break
+		time.sleep( 0.002 )
+	wall = time.time() - start
+	# Negative signal number if it was killed, like subprocess does
+	p.returncode = -os.WTERMSIG( status ) if os.WIFSIGNALED( status ) else os.WEXITSTATUS( status )
+	reader.join()
+	p.stdout.close()
+
+	own = peak_rss( os.getpid() )
+	if own is None:
+		# No /proc, ru_maxrss is in kilobytes on Linux and in bytes on macOS
+		rss = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+	elif usage.ru_maxrss > own:
+		rss = usage.ru_maxrss
+	else:
+		rss = sampled if wall >= 0.02 else None
+	return b"".join( chunks ).decode( errors = "replace" ), wall, rss, p.returncode
+
+
+def read_trace( path ):
+	points = []
+	if os.path.exists( path ):
+		with open( path ) as f:
+			for line in f:
+				fields = line.strip().split( "," )
+				if len( fields ) >= 2:
+					points.append( ( float( fields[0] ), int( fields[1] ) ) )
+	return points
+
+
+# Where MinVC writes the trace of a run, a portfolio of threads LS solvers names it by its first and last seed
+def trace_path( workdir, name, alg, budget, seed, threads ):
+	stem = os.path.join( workdir, "output", name + "_" + alg )
+	if alg == "Approx":
+		return stem + ".trace"
+	if alg == "BnB":
+		return stem + "_%d.trace" % budget
+	if threads > 1:
+		return stem + "_%d_%d-%d.trace" % ( budget, seed, seed + threads - 1 )
+	return stem + "_%d_%d.trace" % ( budget, seed )
+
+
+def bench( args ):
+	workdir = os.path.abspath( args.dir )
+	os.makedirs( os.path.join( workdir, "output" ), exist_ok = True )
+	binary = os.path.abspath( args.bin )
+	instances = [] if args.no_suite else generate( workdir )
+	for spec in args.inst:
+		path, _, target = spec.partition( ":" )
+		instances.append( ( os.path.abspath( path ), int( target ) if target else None ) )
+
+	runs, info = [], {}
+	for path, target in instances:
+		name = os.path.basename( path )[:-6]
+		info[name] = { "path": path, "target": target }
+		for alg in args.algs:
+			# Approx is deterministic, one seed is enough
+			for seed in ( args.seeds[:1] if alg == "Approx" else args.seeds ):
+				cmd = [ "-inst", path, "-alg", alg, "-time", str( args.time ), "-seed", str( seed ), "-threads", str( args.threads ) ]
+				out, wall, rss, code = run( binary, workdir, cmd + args.extra )
+				info[name]["vertices"] = first( r"\|V\| = (\d+)", out, int )
+				info[name]["edges"] = first( r"\|E\| = (\d+)", out, int )
+				weight = first( r"cover weight: (\d+)", out, int )
+				covered = first( r"covered: (\d+)", out, int )
+				# MinVC runs LS1 instead of LS2 on a weighted graph, and the trace is named after what ran
+				ran = "LS1" if alg == "LS2" and "Weighted graph, running LS1" in out else alg
+				res = {
+					"instance": name, "alg": alg, "seed": seed, "time_budget": args.time, "exit_code": code,
+					"load_s": first( r"loaded [^\n]* in ([0-9.e+-]+) s", out ),
+					"wall_s": wall, "peak_rss_kb": rss,
+					"cover": weight if weight is not None else first( r"cover size: (\d+)", out, int ),
+					"valid": covered is not None and covered == info[name]["edges"],
+					"nodes_per_s": first( r"BnB: \d+ nodes \(([0-9.e+-]+) nodes/s\)", out ),
+					"steps_per_s": first( r"LS\d: \d+ steps \(([0-9.e+-]+) steps/s\)", out ),
+					"ran_as": ran,
+					"trace": read_trace( trace_path( workdir, name, ran, args.time, seed, args.threads ) ),
+				}
+				runs.append( res )
+				print( "%-12s %-7s seed %-3d cover %-8s load %.4fs wall %.2fs rss %s kB%s%s" % ( name, alg, seed, res["cover"],
+					res["load_s"] or 0.0, wall, rss, "" if ran == alg else " (ran as %s)" % ran, "" if res["valid"] else " INVALID" ), flush = True )
+
+	# Targets, then the first time each trace reached its target
+	for name, inst in info.items():
+		if inst["target"] is None:
+			covers = [ r["cover"] for r in runs if r["instance"] == name and r["valid"] ]
+			inst["target"] = min( covers ) if covers else None
+	for r in runs:
+		target = info[r["instance"]]["target"]
+		r["target"] = target
+		r["time_to_target_s"] = next( ( t for t, size in r.pop( "trace" ) if target is not None and size <= target ), None )
+
+	return {
+		"binary": binary, "time_budget": args.time, "seeds": args.seeds, "threads": args.threads,
+		"extra_args": args.extra, "instances": info, "runs": runs,
+	}
+
+
+# Mean of a metric per ( instance, alg ), over the runs that have it
+def means( result, metric ):
+	groups = {}
+	for r in result["runs"]:
+		if r.get( metric ) is not None:
+			groups.setdefault( ( r["instance"], r["alg"] ), [] ).append( r[metric] )
+	return { k: sum( v ) / len( v ) for k, v in groups.items() }
+
+
+def compare( result, baseline, tolerance ):
+	worse = []
+	# Higher is better for the rates, lower for the times
+	for metric, higher in ( ( "nodes_per_s", True ), ( "steps_per_s", True ), ( "time_to_target_s", False ), ( "load_s", False ) ):
+		old, new = means( baseline, metric ), means( result, metric )
+		for key in sorted( set( old ) & set( new ) ):
+			a, b = old[key], new[key]
+			if a <= 0.0 or b <= 0.0:
+				continue
+			ratio = b / a if higher else a / b
+			# Times below a millisecond are noise
+			if ratio < 1.0 - tolerance and ( higher or max( a, b ) > 1e-3 ):
+				worse.append( "%s %s %s: %.4g -> %.4g" % ( key[0], key[1], metric, a, b ) )
+	return worse
+
+
+def main():
+	parser = argparse.ArgumentParser()
+	parser.add_argument( "--bin", default = "bin/MinVC" )
+	parser.add_argument( "--dir", default = "bench", help = "where the suite is generated and the runs write output/" )
+	parser.add_argument( "--time", type = int, default = 10, help = "-time of every run, in seconds" )
+	parser.add_argument( "--seeds", type = int, nargs = "+", default = [ 0, 1, 2 ] )
+	parser.add_argument( "--threads", type = int, default = 1 )
+	parser.add_argument( "--algs", nargs = "+", default = ALGS, choices = ALGS )
+	parser.add_argument( "--inst", action = "append", default = [], help = "extra instance, file[:target]" )
+	parser.add_argument( "--no-suite", action = "store_true", help = "only run the --inst instances" )
+	parser.add_argument( "--extra", nargs = argparse.REMAINDER, default = [], help = "more MinVC arguments, must come last" )
+	parser.add_argument( "--out", default = "bench.json" )
+	parser.add_argument( "--baseline", help = "earlier JSON output to check for regressions" )
+	parser.add_argument( "--tolerance", type = float, default = 0.2 )
+	args = parser.parse_args()
+
+	result = bench( args )
+	with open( args.out, "w" ) as f:
+		json.dump( result, f, indent = 1 )
+	print( "Wrote " + args.out )
+
+	if args.baseline:
+		with open( args.baseline ) as f:
+			worse = compare( result, json.load( f ), args.tolerance )
+		for line in worse:
+			print( "Regression: " + line )
+		if worse:
+			return 1
+	return 0 if all( r["valid"] for r in result["runs"] ) else 1
+
+
+if __name__ == "__main__":
+	sys.exit( main() )
@@ -0,0 +1,78 @@
+#ifndef BITGRAPH_H
+#define BITGRAPH_H
+
+#include "graph.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// Kernels over arrays of words 64-bit words, in AVX-512 or AVX2 if the CPU has it and in portable code otherwise
+// The version is picked once, when the program starts
+// *_find	- first set bit at or after from, bit_npos if there is none
+
+const size_t bit_npos = static_cast<size_t>( -1 );
+
+// Number of bits set in a & b
+size_t and_count( const uint64_t *a, const uint64_t *b, size_t words );
+
+// Whether a & b has a bit set
+bool and_any( const uint64_t *a, const uint64_t *b, size_t words );
+
+size_t and_find( const uint64_t *a, const uint64_t *b, size_t from, size_t words );
+
+size_t andnot_find( const uint64_t *a, const uint64_t *b, size_t from, size_t words );
+
+// out = a & b
+void and_store( uint64_t *out, const uint64_t *a, const uint64_t *b, size_t words );
+
+// "avx512", "avx2" or "scalar"
+const char *bit_kernels();
+
+// Set of the ids [0, n) as a bit row
+class BitSet{
+private:
+	vector<uint64_t> bits;
+
+public:
+	BitSet() {}
+
+	BitSet( size_t n ) : bits( ( n + 63 ) / 64, 0 ) {}
+
+	size_t words() const { return bits.size(); }
+
+	const uint64_t *data() const { return bits.data(); }
+
+	uint64_t *data() { return bits.data(); }
+
+	bool test( size_t i ) const { return bits[i / 64] >> ( i % 64 ) & 1; }
+
+	void set( size_t i ){ bits[i / 64] |= uint64_t( 1 ) << ( i % 64 ); }
+
+	void reset( size_t i ){ bits[i / 64] &= ~( uint64_t( 1 ) << ( i % 64 ) ); }
+};
+
+// Adjacency of a graph as one bit row per vertex, for dense graphs
+// At a density of 1 / ( 8 * sizeof( Id ) ) a row takes as much memory as a neighbor list, above it less
+// words	- 64-bit words per row
+// rows		- row v is rows[v * words, ( v + 1 ) * words)
+class BitGraph{
+private:
+	size_t words;
+	vector<uint64_t> rows;
+
+public:
+	BitGraph( const Graph &G );
+
+	// Whether G has more than density * n * ( n - 1 ) / 2 edges
+	static bool dense( const Graph &G, double density );
+
+	size_t num_words() const { return words; }
+
+	const uint64_t *row( Id v ) const { return rows.data() + v * words; }
+
+	bool adjacent( Id u, Id v ) const { return row( u )[v / 64] >> ( v % 64 ) & 1; }
+};
+
+#endif
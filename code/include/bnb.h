@@ -2,7 +2,20 @@
 #define BNB_H
 
 #include "graph.h"
+#include "kernel.h"
 
-void branch_and_bound( Graph &G, int cutoff );
+// Returns the best cover found, lifted to the input graph
+// threads	- number of workers searching in parallel, sharing G
+// bound	- lower bound used for pruning, "matching", "greedy" or "lp"
+// rule		- branching vertex, "maxdeg", "density" (max degree, sparsest neighborhood) or "mirror" (max degree, mirrors taken along)
+// kernel	- the kernel G is, if any
+vector<Id> branch_and_bound( const Graph &G, int cutoff, unsigned threads = 1, const string &bound = "matching", const string &rule = "maxdeg",
+	const Kernel *kernel = nullptr );
+
+bool known_rule( const string &rule );
+
+// Solves the connected components of at most small vertices exactly, within cutoff seconds, their covers are forced
+// The kernel is the rest of the graph, without isolated vertices
+unique_ptr<Kernel> solve_small_components( const Graph &G, Id small, int cutoff );
 
 #endif
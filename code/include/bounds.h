@@ -0,0 +1,99 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "graph.h"
+#include "simplex.h"
+#include "heuristic.h"
+#include <memory>
+
+// Lower bound on the cover weight of the graph left at a BnB node, its size if the graph is unweighted
+// The search removes a vertex by setting removed[u] and then calls take( u ),
+// and calls untake( u ) before clearing removed[u], in reverse order of the takes
+class LowerBound{
+public:
+	virtual ~LowerBound() {}
+
+	virtual void take( Id u ) = 0;
+
+	virtual void untake( Id u ) = 0;
+
+	virtual size_t bound() = 0;
+};
+
+// Size of a maximal matching of the remaining graph, on a weighted graph the lighter end of each matched edge counts
+// After a take only the old mate of u can become unmatched, so repairing the matching is O(deg)
+// mate		- matched neighbor of each vertex, num_vertices() if none
+// trail	- ( vertex, old mate ) pairs to restore on untake
+// marks	- trail length and matched before each take
+class MatchingBound : public LowerBound{
+private:
+	const Graph &G;
+	const vector<bool> &removed;
+	vector<Id> mate;
+	size_t matched;
+	vector<pair<Id, Id>> trail;
+	vector<pair<size_t, size_t>> marks;
+
+	void set_mate( Id u, Id v );
+
+public:
+	MatchingBound( const Graph &G_, const vector<bool> &removed_ );
+
+	void take( Id u );
+
+	void untake( Id u );
+
+	size_t bound() { return matched; }
+};
+
+// Half of the greedybad cover of the remaining graph, recomputed at every node in the same scratch arrays
+class GreedyBound : public LowerBound{
+private:
+	const Graph &G;
+	const vector<bool> &removed;
+	GreedyScratch scratch;
+
+public:
+	GreedyBound( const Graph &G_, const vector<bool> &removed_ ) : G( G_ ), removed( removed_ ) {}
+
+	void take( Id ) {}
+
+	void untake( Id ) {}
+
+	size_t bound();
+};
+
+// Optimum of the LP relaxation of the remaining graph, rounded up
+// Solves the dual, max sum y_e subject to sum of y_e around each vertex <= its weight, whose slack basis is feasible.
+// Edges of taken vertices get cost 0, which keeps the last basis feasible, so each node warm starts from
+// its parent or sibling. Any feasible dual is a lower bound, so an iteration cap only weakens the bound.
+// The cap is small, a node that stops short leaves the basis for the next one to go on from.
+// trail	- edges whose cost was set to 0, marks has the trail length before each take
+// deadline	- of the search, a solve stops at it with the bound it has, null for none
+class LPBound : public LowerBound{
+private:
+	const Graph &G;
+	const vector<bool> &removed;
+	RevisedSimplex lp;
+	vector<Id> trail;
+	vector<size_t> marks;
+	size_t max_iter;
+	Deadline *deadline;
+
+public:
+	LPBound( const Graph &G_, const vector<bool> &removed_, Deadline *deadline_ = nullptr );
+
+	void take( Id u );
+
+	void untake( Id u );
+
+	size_t bound();
+};
+
+bool known_bound( const string &name );
+
+// name		- "matching", "greedy" or "lp", nullptr if unknown
+// deadline	- of the search, for a bound that may take long on a single node
+unique_ptr<LowerBound> make_bound( const string &name, const Graph &G, const vector<bool> &removed, Deadline *deadline = nullptr );
+
+#endif
\ No newline at end of file
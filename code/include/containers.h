@@ -0,0 +1,278 @@
+#ifndef CONTAINERS_H
+#define CONTAINERS_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+// Set of ids in [0, n) with O(1) insert, erase, membership test and uniform sampling
+// items	- members in no particular order, erase moves the last one into the hole
+// pos		- position of each id in items, npos if absent
+template <class T>
+class IndexedSet{
+private:
+	vector<T> items;
+	vector<size_t> pos;
+
+public:
+	static const size_t npos = static_cast<size_t>( -1 );
+
+	IndexedSet() {}
+
+	IndexedSet( size_t n ) : pos( n, npos ) {}
+
+	bool empty() const { return items.empty(); }
+
+	size_t size() const { return items.size(); }
+
+	bool contains( T id ) const { return pos[id] != npos; }
+
+	const T *begin() const { return items.data(); }
+
+	const T *end() const { return items.data() + items.size(); }
+
+	// Member at a position, for uniform sampling
+	T at( size_t i ) const { return items[i]; }
+
+	T back() const { return items.back(); }
+
+	bool insert( T id ){
+		if ( pos[id] != npos )
+			return false;
+		pos[id] = items.size();
+		items.push_back( id );
+		return true;
+	}
+
+	bool erase( T id ){
+		size_t i = pos[id];
+		if ( i == npos )
+			return false;
+		pos[id] = npos;
+		T last = items.back();
+		items.pop_back();
+		if ( i != items.size() ){
+			items[i] = last;
+			pos[last] = i;
+		}
+		return true;
+	}
+
+	void swap( IndexedSet &other ){
+		items.swap( other.items );
+		pos.swap( other.pos );
+	}
+
+	// O(size()), not O(n)
+	void clear(){
+		for ( T id : items )
+			pos[id] = npos;
+		items.clear();
+	}
+};
+
+template <class T>
+const size_t IndexedSet<T>::npos;
+
+// Ids [0, n) kept sorted by a small integer key that moves by one at a time, like vertex degrees
+// Changing a key by one swaps the id with the first or last one of its bucket, so it is O(1), and so is the max
+// items	- ids by ascending key
+// pos		- position of each id in items
+// start	- position of the first id with key at least k, for each k up to the largest initial key + 1
+// key		- current key of each id, it can not grow beyond the largest initial key
+template <class T>
+class BucketQueue{
+private:
+	vector<T> items;
+	vector<size_t> pos, start, key;
+
+	void swap_ids( size_t i, size_t j ){
+		T a = items[i], b = items[j];
+		items[i] = b;
+		pos[b] = i;
+		items[j] = a;
+		pos[a] = j;
+	}
+
+public:
+	BucketQueue() {}
+
+	template <class Key>
+	BucketQueue( const vector<Key> &keys ){ assign( keys ); }
+
+	// Starts over with new keys, reusing the arrays of the last ones
+	template <class Key>
+	void assign( const vector<Key> &keys ){
+		items.resize( keys.size() );
+		pos.resize( keys.size() );
+		key.assign( keys.begin(), keys.end() );
+		size_t top = 0;
+		for ( size_t k : key )
+			top = k > top ? k : top;
+		start.assign( top + 2, 0 );
+		for ( size_t k : key )
+			++start[k + 1];
+		for ( size_t k = 1; k < start.size(); ++k )
+			start[k] += start[k - 1];
+		// start[k] is the next free position of bucket k while placing, then shifted back by one bucket
+		for ( size_t id = 0; id < key.size(); ++id ){
+			pos[id] = start[key[id]]++;
+			items[pos[id]] = id;
+		}
+		for ( size_t k = start.size() - 1; k > 0; --k )
+			start[k] = start[k - 1];
+		start[0] = 0;
+	}
+
+	size_t get( T id ) const { return key[id]; }
+
+	// An id with the largest key, only valid if there are ids
+	T top() const { return items.back(); }
+
+	size_t top_key() const { return items.empty() ? 0 : key[items.back()]; }
+
+	// Ids with key k
+	const T *begin( size_t k ) const { return items.data() + start[k]; }
+
+	const T *end( size_t k ) const { return items.data() + start[k + 1]; }
+
+	void increment( T id ){
+		size_t k = key[id]++;
+		swap_ids( pos[id], --start[k + 1] );
+	}
+
+	void decrement( T id ){
+		size_t k = key[id]--;
+		swap_ids( pos[id], start[k]++ );
+	}
+
+	// O( difference of the keys )
+	void set( T id, size_t k ){
+		while ( key[id] > k )
+			decrement( id );
+		while ( key[id] < k )
+			increment( id );
+	}
+};
+
+// Arrays of a recursive search, each call pushes its own on top and pops them before it returns
+// The storage only grows to the deepest the search went, so a pop is O(1) and later calls allocate nothing.
+// Pushes may move the storage, so arrays are addressed by their start position, not by pointer.
+// items	- all live arrays, back to back
+template <class T>
+class ScratchStack{
+private:
+	vector<T> items;
+
+public:
+	// Position the next array starts at, pass it to pop to drop everything pushed since
+	size_t top() const { return items.size(); }
+
+	void push( T x ){ items.push_back( x ); }
+
+	T operator[]( size_t i ) const { return items[i]; }
+
+	void pop( size_t mark ){ items.resize( mark ); }
+};
+
+// Binary min-heap over the ids [0, n), ordered by an external key array
+// heap		- ids in heap order
+// pos		- position of each id in heap, npos if absent
+// key		- keys are read through this, call update( id ) after changing one
+template <class T, class Key>
+class IndexedMinHeap{
+private:
+	vector<T> heap;
+	vector<size_t> pos;
+	const vector<Key> *key;
+
+	bool less( size_t a, size_t b ) const { return ( *key )[heap[a]] < ( *key )[heap[b]]; }
+
+	void place( size_t i, T id ){
+		heap[i] = id;
+		pos[id] = i;
+	}
+
+	void sift_up( size_t i ){
+		T id = heap[i];
+		while ( i > 0 && ( *key )[id] < ( *key )[heap[( i - 1 ) / 2]] ){
+			place( i, heap[( i - 1 ) / 2] );
+			i = ( i - 1 ) / 2;
+		}
+		place( i, id );
+	}
+
+	void sift_down( size_t i ){
+		T id = heap[i];
+		while ( true ){
+			size_t c = 2 * i + 1;
+			if ( c >= heap.size() )
+				break;
+			if ( c + 1 < heap.size() && less( c + 1, c ) )
+				++c;
+			if ( !( ( *key )[heap[c]] < ( *key )[id] ) )
+				break;
+			place( i, heap[c] );
+			i = c;
+		}
+		place( i, id );
+	}
+
+public:
+	static const size_t npos = static_cast<size_t>( -1 );
+
+	IndexedMinHeap() : key( nullptr ) {}
+
+	IndexedMinHeap( size_t n, const vector<Key> &key_ ) : pos( n, npos ), key( &key_ ) {}
+
+	bool empty() const { return heap.empty(); }
+
+	size_t size() const { return heap.size(); }
+
+	bool contains( T id ) const { return pos[id] != npos; }
+
+	T top() const { return heap[0]; }
+
+	// Smallest id other than top(), only valid if size() > 1
+	T second() const {
+		return heap.size() > 2 && less( 2, 1 ) ? heap[2] : heap[1];
+	}
+
+	// Id at a position of the heap array, for uniform sampling
+	T at( size_t i ) const { return heap[i]; }
+
+	void push( T id ){
+		heap.push_back( id );
+		pos[id] = heap.size() - 1;
+		sift_up( heap.size() - 1 );
+	}
+
+	void erase( T id ){
+		size_t i = pos[id];
+		pos[id] = npos;
+		T last = heap.back();
+		heap.pop_back();
+		if ( i == heap.size() )
+			return;
+		place( i, last );
+		update( last );
+	}
+
+	void update( T id ){
+		size_t i = pos[id];
+		sift_up( i );
+		sift_down( pos[id] );
+	}
+
+	// Restore heap order after many keys changed
+	void rebuild(){
+		for ( size_t i = heap.size() / 2; i-- > 0; )
+			sift_down( i );
+	}
+};
+
+template <class T, class Key>
+const size_t IndexedMinHeap<T, Key>::npos;
+
+#endif
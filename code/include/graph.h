@@ -8,34 +8,139 @@
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
+#include <memory>
 #include "utils.h"
 
 using namespace std;
 using Id = unsigned long;
 using Edge = pair<Id, Id>;
 
-class Vertex{
+// A contiguous slice of one of the CSR arrays
+class Neighbors{
 public:
-	unordered_set<Id> neighs;
+	const Id *first, *last;
+
+	Neighbors( const Id *first_, const Id *last_ ) : first( first_ ), last( last_ ) {}
+
+	const Id *begin() const { return first; }
+
+	const Id *end() const { return last; }
+
+	size_t size() const { return last - first; }
+
+	bool empty() const { return first == last; }
+
+	Id operator[]( size_t i ) const { return first[i]; }
 };
 
-namespace std {
-	template <>
-	class hash<Edge>{
-	public:
-		size_t operator()( const Edge &name ) const;
-	};
+// Read-only view of an array
+template <class T>
+class ArrayView{
+public:
+	const T *ptr;
+	size_t len;
+
+	ArrayView() : ptr( nullptr ), len( 0 ) {}
+
+	ArrayView( const T *ptr_, size_t len_ ) : ptr( ptr_ ), len( len_ ) {}
+
+	ArrayView( const vector<T> &v ) : ptr( v.data() ), len( v.size() ) {}
+
+	const T *data() const { return ptr; }
+
+	const T *begin() const { return ptr; }
+
+	const T *end() const { return ptr + len; }
+
+	size_t size() const { return len; }
+
+	const T &operator[]( size_t i ) const { return ptr[i]; }
 };
 
+// Compressed sparse row graph
+// offsets		- neighbors of v are adjacency[offsets[v], offsets[v + 1])
+// adjacency	- neighbor lists, each one sorted ascending
+// edge_ids		- id of the edge to adjacency[i] is edge_ids[i]
+// edges		- endpoints of each edge id, smaller one first
+// weights		- weight of each vertex, empty if the graph is unweighted and every weight is 1
+// source		- path of the text file the graph was parsed from
+// The arrays view the *_data vectors
 class Graph{
 public:
 	string filename;
-	vector<Vertex> vertices;
-	unordered_map<Edge, bool> edges;
+	string source;
+	ArrayView<Id> offsets;
+	ArrayView<Id> adjacency;
+	ArrayView<Id> edge_ids;
+	ArrayView<Edge> edges;
+	ArrayView<Id> weights;
+
+	// infile	- a text graph, or a snapshot written by dump
+	// threads	- number of threads parsing a text file in chunks
+	Graph( string infile, unsigned threads = 1 );
+
+	// Subgraph of G induced by keep, vertex i of it is keep[i] of G, with its weight
+	Graph( const Graph &G, const vector<Id> &keep );
+
+	// Graph with the neighbors lists[i] for each vertex i, every edge listed from both ends
+	// weights_	- weight of each vertex, empty for an unweighted graph
+	Graph( const vector<vector<Id>> &lists, const string &filename_, const vector<Id> &weights_ = vector<Id>() );
+
+	// Graph with the neighbors adjacency_[offsets_[i], offsets_[i + 1]) for each vertex i, in any order, every edge listed from both ends
+	// Takes the arrays over, so a caller building one in place allocates nothing per vertex
+	Graph( vector<Id> &&offsets_, vector<Id> &&adjacency_, const string &filename_, const vector<Id> &weights_ = vector<Id>() );
+
+	Graph( const Graph & ) = delete;
+
+	Graph &operator=( const Graph & ) = delete;
+
+	// Write a compact binary snapshot that the constructor reads back without parsing
+	void dump( const string &outfile ) const;
+
+	Id num_vertices() const { return offsets.size() - 1; }
+
+	Id num_edges() const { return edges.size(); }
+
+	Id degree( Id v ) const { return offsets[v + 1] - offsets[v]; }
+
+	bool weighted() const { return weights.size() != 0; }
+
+	Id weight( Id v ) const { return weights.size() != 0 ? weights[v] : 1; }
+
+	// Total weight of a set of vertices, its size if the graph is unweighted
+	Id weight( const vector<Id> &VC ) const;
+
+	Neighbors neighs( Id v ) const {
+		return Neighbors( adjacency.data() + offsets[v], adjacency.data() + offsets[v + 1] );
+	}
+
+	// Ids of the edges to neighs( v ), in the same order
+	Neighbors incident( Id v ) const {
+		return Neighbors( edge_ids.data() + offsets[v], edge_ids.data() + offsets[v + 1] );
+	}
+
+	// Binary search in the shorter of the two neighbor lists
+	bool adjacent( Id u, Id v ) const;
+
+	// Id of edge {u, v}, or num_edges() if there is no such edge
+	Id edge_id( Id u, Id v ) const;
+
+	void check_coverage( const vector<Id> &VC ) const;
+
+	// Vertex sets of the connected components with at least one edge, smallest first
+	vector<vector<Id>> components() const;
+
+private:
+	vector<Id> offsets_data, adjacency_data, edge_ids_data, weights_data;
+	vector<Edge> edges_data;
+
+	void load_text( const MappedFile &file, unsigned threads );
 
-	Graph( string infile );
+	// Sort the neighbor lists of offsets/adjacency_data, number the edges and point the views at the data
+	void build( unsigned threads );
 
-	void check_coverage( vector<Id> &VC );
+	// Reads the graph from file if it is a valid, up to date snapshot
+	bool load_snapshot( const MappedFile &file, unsigned threads );
 };
 
 Edge edge( Id e1, Id e2 );
@@ -2,15 +2,39 @@
 #define HEURISTIC_H
 
 #include "graph.h"
+#include "kernel.h"
+#include "containers.h"
 
-vector<Id> greedybad( Graph &G );
+vector<Id> greedybad( const Graph &G, const vector<bool> &removed = vector<bool>() );
 
-vector<Id> heuristic1( Graph &G );
+// Arrays of greedybad, kept by callers that run it again and again so that a run allocates nothing
+struct GreedyScratch{
+	vector<bool> gone;
+	vector<Id> deg, VC;
+	BucketQueue<Id> bydeg;
+};
 
-vector<Id> heuristic2( Graph &G );
+// The greedybad cover, in scratch.VC
+const vector<Id> &greedybad( const Graph &G, const vector<bool> &removed, GreedyScratch &scratch );
 
-void heuristic( Graph &G );
+vector<Id> heuristic1( const Graph &G );
 
-vector<Id> getBestHeuristic( Graph &G );
+vector<Id> heuristic2( const Graph &G );
+
+// Both endpoints of a maximal matching built in handshake rounds, minus vertices the rest covers for
+vector<Id> parallel_matching( const Graph &G, unsigned threads );
+
+// Max degree greedy in rounds, each round takes the candidates of the top degree level that beat their candidate neighbors
+vector<Id> parallel_greedy( const Graph &G, unsigned threads );
+
+// Bar-Yehuda and Even, a 2-approximation of the minimum weight cover, without the vertices it does not need
+vector<Id> primal_dual( const Graph &G );
+
+// Writes the trace and .sol of the smallest of parallel_matching, parallel_greedy and heuristic3,
+// or of primal_dual if G is weighted, returns that cover lifted to the input graph
+vector<Id> heuristic( const Graph &G, unsigned threads = 1, const Kernel *kernel = nullptr );
+
+// Smallest cover of heuristic1-3, the primal_dual one if G is weighted
+vector<Id> getBestHeuristic( const Graph &G );
 
 #endif
@@ -0,0 +1,46 @@
+#ifndef INCUMBENT_H
+#define INCUMBENT_H
+
+#include "graph.h"
+#include "kernel.h"
+#include <atomic>
+#include <mutex>
+#include "timer.h"
+
+// Best cover size found by any solver thread of a run, and the merged trace of it
+// best		- size of the best cover, readable without taking the lock
+// owner	- thread that found the best cover, its solver still holds the cover itself
+// start	- starting time point of the run, trace times are relative to it
+// outfile	- output path without the .trace/.sol extension
+// kernel	- if the solvers work on a kernel, the trace and .sol are about the lifted covers
+class Incumbent{
+private:
+	mutex lock;
+	atomic<size_t> best;
+	unsigned owner;
+	TimePoint start;
+	ofstream ofs;
+	string outfile;
+	const Kernel *kernel;
+
+public:
+	// Time spent building the kernel counts as part of the run
+	Incumbent( const string &outfile_, TimePoint start_, const Kernel *kernel_ = nullptr );
+
+	// Of the best cover of the graph the solvers see
+	size_t size() const { return best.load( memory_order_relaxed ); }
+
+	unsigned best_thread() const { return owner; }
+
+	// Forget the best size, after the graph changed under the solvers, the trace goes on
+	void reset(){ best.store( static_cast<size_t>( -1 ), memory_order_relaxed ); }
+
+	// Record a cover found by thread if it is smaller than the best one, adding a trace line
+	// rate	- steps per second appended to the trace line, left out if negative
+	bool offer( size_t size, unsigned thread, double rate = -1.0 );
+
+	// Write the .sol file of a cover, returns it lifted to the input graph
+	vector<Id> write_solution( const vector<Id> &VC ) const;
+};
+
+#endif
\ No newline at end of file
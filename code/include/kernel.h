@@ -0,0 +1,53 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include "graph.h"
+#include <memory>
+
+// A degree-2 vertex v whose neighbors u and w were merged into u
+// Lifting takes u and w if the merged u is in the cover, v otherwise
+struct Fold{
+	Id v, u, w;
+};
+
+// A smaller graph whose vertex covers lift to vertex covers of the input graph
+// graph		- the kernel, its vertex i is vertex original[i] of the input
+// forced		- input vertices that every lifted cover contains
+// folds		- in the order they were made, lifting undoes them in reverse
+// heavy		- weight of forced beyond one per vertex, 0 unless the input is weighted
+// input_size	- number of vertices of the input graph
+// seconds		- time it took to build the kernel
+class Kernel{
+public:
+	unique_ptr<Graph> graph;
+	vector<Id> original;
+	vector<Id> forced;
+	vector<Fold> folds;
+	Id heavy;
+	Id input_size;
+	double seconds;
+
+	Kernel() : heavy( 0 ), input_size( 0 ), seconds( 0.0 ) {}
+
+	// Weight a cover of the kernel grows by when it is lifted
+	size_t offset() const { return forced.size() + heavy + folds.size(); }
+
+	vector<Id> lift( const vector<Id> &VC ) const;
+
+	// Continue with a kernel of this kernel's graph
+	void compose( unique_ptr<Kernel> next );
+};
+
+// Twice the optimal half-integral solution of the vertex cover LP, 0, 1 or 2 for each vertex
+// From a maximum matching of the bipartite double cover by Hopcroft-Karp, O( E sqrt( V ) )
+vector<char> half_integral_lp( const Graph &G );
+
+// Nemhauser-Trotter: vertices at 1 go into the cover, vertices at 0 are dropped, the kernel is the rest
+// Some minimum cover of G is forced plus a minimum cover of the kernel
+unique_ptr<Kernel> nemhauser_trotter( const Graph &G );
+
+// Applies degree-0/1/2 (triangle and fold), domination and degree-3 twin rules until none applies,
+// then Nemhauser-Trotter, which also removes crowns, and repeats while that shrinks the graph
+unique_ptr<Kernel> reduce( const Graph &G );
+
+#endif
\ No newline at end of file
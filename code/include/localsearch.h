@@ -2,9 +2,19 @@
 #define LOCALSEARCH_H
 
 #include "graph.h"
+#include "kernel.h"
+#include "incumbent.h"
+#include <atomic>
 
-void localsearch1( Graph &G, int cutoff, int seed );
+// Return the best cover found, lifted to the input graph
+// threads	- number of solvers run in parallel with consecutive seeds, sharing G
+// kernel	- the kernel G is, if any
+vector<Id> localsearch1( const Graph &G, int cutoff, int seed, unsigned threads = 1, const Kernel *kernel = nullptr );
 
-void localsearch2( Graph &G, int cutoff, int seed );
+// dense	- edge density above which the graph is also kept as bit rows, which speed up the adjacency tests of LS2
+vector<Id> localsearch2( const Graph &G, int cutoff, int seed, unsigned threads = 1, const Kernel *kernel = nullptr, double dense = 1.0 / 32 );
+
+// One LS1 solver started from the cover initial, until the cutoff or until stop is set, returns the best cover it saw
+vector<Id> improve_cover( const Graph &G, const vector<Id> &initial, double cutoff, int seed, Incumbent &incumbent, const atomic<bool> &stop );
 
 #endif
@@ -0,0 +1,16 @@
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include "graph.h"
+
+// Long running mode, keeps a cover of a changing graph, one command per line of in, answers on out
+//	a U V	- insert edge {U, V}, vertex ids start at 1 as in the input file, a new id grows the graph
+//	d U V	- delete edge {U, V}
+//	s		- "cover W N", weight and size of the best cover of the graph with all updates read so far
+//	q		- the same line, then the cover, comma separated
+// Updates are applied in batches, when a query comes or no more lines are waiting. Edges a batch leaves uncovered
+// get their higher degree end, then LS1 improves the cover for up to cutoff seconds, or until the next line arrives
+// The best cover is written to output/ once in is closed
+void serve( const Graph &G, int cutoff, int seed, istream &in, ostream &out );
+
+#endif
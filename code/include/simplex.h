@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <unordered_set>
+#include "timer.h"
 
 using namespace std;
 
@@ -30,6 +31,86 @@ public:
 	size_t col_size();
 };
 
+// Revised simplex for max c^T x subject to A x <= b, x >= 0, with b >= 0 so the all slack basis is feasible
+// Columns of A are sparse, B^-1 is kept in product form and reinverted every refactor pivots.
+// Changing costs keeps the basis primal feasible, so solve() warm starts from the last basis.
+// Columns [0, cols()) are the structural ones, cols() + i is the slack of row i.
+// head			- column that is basic in each row
+// pos			- row of each basic column, npos if nonbasic
+// xB			- value of the basic column of each row
+// etas			- pivot row, pivot element and the range of eta_entries of each eta column
+// updates		- pivots since the last reinversion
+// price_start	- where the next partial pricing scan starts
+// work			- dense scratch column, nonzeros lists the rows it may be nonzero in
+class RevisedSimplex{
+private:
+	struct Eta{
+		size_t row;
+		double pivot;
+		size_t first, last;
+	};
+
+	size_t m;
+	vector<double> b, cost;
+	vector<size_t> col_start, col_row;
+	vector<double> col_val;
+	vector<size_t> head, pos;
+	vector<double> xB;
+	vector<Eta> etas;
+	vector<pair<size_t, double>> eta_entries;
+	size_t refactor, updates, price_start;
+
+	vector<double> work, dual;
+	vector<char> inlist;
+	vector<size_t> nonzeros;
+
+	void touch( size_t i );
+
+	void clear_work();
+
+	void load_column( size_t j );
+
+	void ftran();
+
+	void btran();
+
+	void add_eta( size_t row );
+
+	void init();
+
+	void reinvert();
+
+	size_t price();
+
+public:
+	static const size_t npos = static_cast<size_t>( -1 );
+
+	RevisedSimplex( const vector<double> &b_, size_t refactor_ = 64 );
+
+	// Add a structural column, nonbasic at 0, before the first solve()
+	size_t add_column( double c, const vector<pair<size_t, double>> &entries );
+
+	size_t rows() const { return m; }
+
+	size_t cols() const { return cost.size(); }
+
+	double get_cost( size_t j ) const { return cost[j]; }
+
+	void set_cost( size_t j, double c ){ cost[j] = c; }
+
+	// Start from a basis where each ( column, row ) pair replaces the slack of row, before the first solve()
+	// Falls back to the all slack basis if that one is singular or infeasible
+	void crash( const vector<pair<size_t, size_t>> &basis );
+
+	// Pivot until optimal, false if it stopped at max_iter, at the deadline or found the LP unbounded
+	// The basis stays feasible either way, so objective() is always attained
+	bool solve( size_t max_iter, Deadline *deadline = nullptr );
+
+	double objective() const;
+
+	double value( size_t j ) const { return pos[j] == npos ? 0.0 : xB[pos[j]]; }
+};
+
 vector<double> get_solution( Tableau &tab );
 
 bool simplex( Tableau &tab );
@@ -0,0 +1,64 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <ostream>
+
+using namespace std;
+
+// Named counters of one solver, sampled by the StatsSampler while the solver runs
+// Only the owning thread writes them, so add and raise are a relaxed load and store rather than a locked instruction
+// label	- which solver, e.g. "LS1 0" for the solver of thread 0
+// names	- of the counters, in index order
+class Counters{
+private:
+	string label;
+	vector<string> names;
+	unique_ptr<atomic<unsigned long long>[]> values;
+	bool sampled;
+
+public:
+	// sampled	- register with the sampler, if one runs, until destroyed
+	Counters( const string &label_, const vector<string> &names_, bool sampled_ = true );
+
+	~Counters();
+
+	Counters( const Counters & ) = delete;
+
+	Counters &operator=( const Counters & ) = delete;
+
+	void add( size_t i, unsigned long long d = 1 ){
+		values[i].store( values[i].load( memory_order_relaxed ) + d, memory_order_relaxed );
+	}
+
+	// Counter i becomes at least v
+	void raise( size_t i, unsigned long long v ){
+		if ( v > values[i].load( memory_order_relaxed ) )
+			values[i].store( v, memory_order_relaxed );
+	}
+
+	unsigned long long get( size_t i ) const { return values[i].load( memory_order_relaxed ); }
+
+	// "label name=value ..."
+	void write( ostream &os ) const;
+};
+
+// Writes a line for every registered Counters each period seconds, from a thread of its own,
+// and a last one for each when it is destroyed. Lines start with the seconds since the sampler started.
+// There is at most one sampler at a time, Counters made while there is none are not sampled.
+class StatsSampler{
+public:
+	// path	- file to write, "-" for stderr
+	StatsSampler( const string &path, double period );
+
+	~StatsSampler();
+
+	StatsSampler( const StatsSampler & ) = delete;
+
+	StatsSampler &operator=( const StatsSampler & ) = delete;
+};
+
+#endif
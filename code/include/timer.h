@@ -0,0 +1,43 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <chrono>
+#include <atomic>
+
+using namespace std;
+
+// Every algorithm times its run and its trace on the monotonic clock
+using Clock = chrono::steady_clock;
+using TimePoint = Clock::time_point;
+using SecondsDouble = chrono::duration<double>;
+
+inline double seconds_since( TimePoint start ){ return SecondsDouble( Clock::now() - start ).count(); }
+
+// Cutoff of a run, for a hot loop that asks expired() once per step
+// The clock is only read every stride calls. The stride doubles while reads are less than a tenth of a millisecond
+// apart and halves once they are more than a millisecond apart, so the cutoff is overshot by about a millisecond.
+// stop	- ends the run early once set, looked at on every call
+class Deadline{
+private:
+	TimePoint end, last;
+	unsigned stride, count;
+	bool over;
+	const atomic<bool> *stop;
+
+	bool check();
+
+public:
+	// seconds	- after start
+	Deadline( TimePoint start, double seconds, const atomic<bool> *stop_ = nullptr );
+
+	bool expired(){
+		if ( over || ( stop && stop->load( memory_order_relaxed ) ) )
+			return over = true;
+		if ( ++count < stride )
+			return false;
+		count = 0;
+		return check();
+	}
+};
+
+#endif
@@ -5,9 +5,60 @@
 #include <vector>
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <cstdint>
 
 void _split( const std::string &s, char delim, std::vector<std::string> &elems );
 
 std::vector<std::string> split( const std::string &s, char delim );
 
+// Size and modification time of a file, false if it does not exist
+bool file_stamp( const std::string &path, uint64_t &size, int64_t &mtime );
+
+// Fast 64 bit checksum of a buffer whose size is a multiple of 8 bytes. Chain calls through h.
+uint64_t checksum( const void *data, size_t bytes, uint64_t h );
+
+// Read-only view of a whole file. Memory mapped where the platform supports it,
+// read into a buffer otherwise.
+class MappedFile{
+private:
+	const char *_data;
+	size_t _size;
+	bool _good;
+	std::vector<char> buffer;
+
+public:
+	MappedFile( const std::string &path );
+
+	~MappedFile();
+
+	MappedFile( const MappedFile & ) = delete;
+
+	MappedFile &operator=( const MappedFile & ) = delete;
+
+	bool good() const { return _good; }
+
+	const char *data() const { return _data; }
+
+	size_t size() const { return _size; }
+
+	// Hint that the file is read front to back from now on (on), or in no particular order (off, the default)
+	// Only a mapped file takes the hint
+	void sequential( bool on ) const;
+};
+
+// Splits [0, n) into one contiguous range per thread and calls f( t, begin, end ) on each
+template <class F>
+void parallel_for( unsigned threads, size_t n, F f ){
+	if ( threads <= 1 || n < threads ){
+		f( 0u, size_t( 0 ), n );
+		return;
+	}
+	std::vector<std::thread> workers;
+	for ( unsigned t = 0; t < threads; ++t )
+		workers.emplace_back( f, t, n * t / threads, n * ( t + 1 ) / threads );
+	for ( std::thread &w : workers )
+		w.join();
+}
+
 #endif
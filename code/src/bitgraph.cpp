@@ -0,0 +1,226 @@
+#include "bitgraph.h"
+
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+#define BITGRAPH_X86
+#include <immintrin.h>
+#endif
+
+// Index of the lowest set bit of x, which is not 0
+static inline size_t lowest( uint64_t x ){ return __builtin_ctzll( x ); }
+
+// a & b, or a & ~b if Not
+template <bool Not>
+static inline uint64_t combine( uint64_t a, uint64_t b ){ return Not ? a & ~b : a & b; }
+
+// Lowest set bit of word w, masked to bits from on if it holds from, then of the next words up to end
+template <bool Not>
+static inline size_t scan( const uint64_t *a, const uint64_t *b, size_t w, size_t end, uint64_t mask ){
+	for ( ; w < end; ++w, mask = ~uint64_t( 0 ) ){
+		uint64_t x = combine<Not>( a[w], b[w] ) & mask;
+		if ( x != 0 )
+			return w * 64 + lowest( x );
+	}
+	return bit_npos;
+}
+
+static size_t count_scalar( const uint64_t *a, const uint64_t *b, size_t words ){
+	size_t n = 0;
+	for ( size_t w = 0; w < words; ++w )
+		n += __builtin_popcountll( a[w] & b[w] );
+	return n;
+}
+
+static bool any_scalar( const uint64_t *a, const uint64_t *b, size_t words ){
+	for ( size_t w = 0; w < words; ++w )
+		if ( ( a[w] & b[w] ) != 0 )
+			return true;
+	return false;
+}
+
+template <bool Not>
+static size_t find_scalar( const uint64_t *a, const uint64_t *b, size_t from, size_t words ){
+	if ( from / 64 >= words )
+		return bit_npos;
+	return scan<Not>( a, b, from / 64, words, ~uint64_t( 0 ) << ( from % 64 ) );
+}
+
+static void store_scalar( uint64_t *out, const uint64_t *a, const uint64_t *b, size_t words ){
+	for ( size_t w = 0; w < words; ++w )
+		out[w] = a[w] & b[w];
+}
+
+#ifdef BITGRAPH_X86
+
+// Bits set in each 64-bit lane, from a nibble table, since AVX2 has no vector popcount
+__attribute__(( target( "avx2" ) ))
+static inline __m256i popcount_avx2( __m256i v ){
+	const __m256i table = _mm256_setr_epi8( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+	const __m256i low = _mm256_set1_epi8( 0x0f );
+	__m256i bytes = _mm256_add_epi8( _mm256_shuffle_epi8( table, _mm256_and_si256( v, low ) ),
+		_mm256_shuffle_epi8( table, _mm256_and_si256( _mm256_srli_epi16( v, 4 ), low ) ) );
+	return _mm256_sad_epu8( bytes, _mm256_setzero_si256() );
+}
+
+__attribute__(( target( "avx2" ) ))
+static size_t count_avx2( const uint64_t *a, const uint64_t *b, size_t words ){
+	__m256i sum = _mm256_setzero_si256();
+	size_t w = 0;
+	for ( ; w + 4 <= words; w += 4 ){
+		__m256i x = _mm256_and_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i *>( a + w ) ),
+			_mm256_loadu_si256( reinterpret_cast<const __m256i *>( b + w ) ) );
+		sum = _mm256_add_epi64( sum, popcount_avx2( x ) );
+	}
+	uint64_t lanes[4];
+	_mm256_storeu_si256( reinterpret_cast<__m256i *>( lanes ), sum );
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + count_scalar( a + w, b + w, words - w );
+}
+
+__attribute__(( target( "avx2" ) ))
+static bool any_avx2( const uint64_t *a, const uint64_t *b, size_t words ){
+	size_t w = 0;
+	for ( ; w + 4 <= words; w += 4 )
+		if ( !_mm256_testz_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i *>( a + w ) ),
+			_mm256_loadu_si256( reinterpret_cast<const __m256i *>( b + w ) ) ) )
+			return true;
+	return any_scalar( a + w, b + w, words - w );
+}
+
+// The word holding from is done alone, then blocks of 4 are skipped while they are empty
+template <bool Not>
+__attribute__(( target( "avx2" ) ))
+static size_t find_avx2( const uint64_t *a, const uint64_t *b, size_t from, size_t words ){
+	size_t w = from / 64;
+	if ( w >= words )
+		return bit_npos;
+	size_t found = scan<Not>( a, b, w, w + 1, ~uint64_t( 0 ) << ( from % 64 ) );
+	if ( found != bit_npos )
+		return found;
+	for ( ++w; w + 4 <= words; w += 4 ){
+		__m256i x = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( a + w ) );
+		__m256i y = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( b + w ) );
+		// testc( y, x ) is whether x & ~y is empty
+		if ( !( Not ? _mm256_testc_si256( y, x ) : _mm256_testz_si256( x, y ) ) )
+			return scan<Not>( a, b, w, w + 4, ~uint64_t( 0 ) );
+	}
+	return scan<Not>( a, b, w, words, ~uint64_t( 0 ) );
+}
+
+__attribute__(( target( "avx2" ) ))
+static void store_avx2( uint64_t *out, const uint64_t *a, const uint64_t *b, size_t words ){
+	size_t w = 0;
+	for ( ; w + 4 <= words; w += 4 )
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>( out + w ), _mm256_and_si256(
+			_mm256_loadu_si256( reinterpret_cast<const __m256i *>( a + w ) ), _mm256_loadu_si256( reinterpret_cast<const __m256i *>( b + w ) ) ) );
+	store_scalar( out + w, a + w, b + w, words - w );
+}
+
+// AVX-512 popcount needs the VPOPCNTDQ extension on top of AVX-512F, count_avx2 stands in without it
+__attribute__(( target( "avx512f,avx512vpopcntdq" ) ))
+static size_t count_avx512( const uint64_t *a, const uint64_t *b, size_t words ){
+	__m512i sum = _mm512_setzero_si512();
+	size_t w = 0;
+	for ( ; w + 8 <= words; w += 8 )
+		sum = _mm512_add_epi64( sum, _mm512_popcnt_epi64( _mm512_and_si512( _mm512_loadu_si512( a + w ), _mm512_loadu_si512( b + w ) ) ) );
+	uint64_t lanes[8];
+	_mm512_storeu_si512( lanes, sum );
+	size_t n = count_scalar( a + w, b + w, words - w );
+	for ( uint64_t x : lanes )
+		n += x;
+	return n;
+}
+
+__attribute__(( target( "avx512f" ) ))
+static bool any_avx512( const uint64_t *a, const uint64_t *b, size_t words ){
+	size_t w = 0;
+	for ( ; w + 8 <= words; w += 8 )
+		if ( _mm512_test_epi64_mask( _mm512_loadu_si512( a + w ), _mm512_loadu_si512( b + w ) ) != 0 )
+			return true;
+	return any_scalar( a + w, b + w, words - w );
+}
+
+// The lanes of a block that are not empty come as a mask, so the first one is found without a scan
+template <bool Not>
+__attribute__(( target( "avx512f" ) ))
+static size_t find_avx512( const uint64_t *a, const uint64_t *b, size_t from, size_t words ){
+	size_t w = from / 64;
+	if ( w >= words )
+		return bit_npos;
+	size_t found = scan<Not>( a, b, w, w + 1, ~uint64_t( 0 ) << ( from % 64 ) );
+	if ( found != bit_npos )
+		return found;
+	for ( ++w; w + 8 <= words; w += 8 ){
+		__m512i x = _mm512_loadu_si512( a + w ), y = _mm512_loadu_si512( b + w );
+		// x ^ ( x & y ) is x & ~y, _mm512_andnot_si512 draws a false warning from some GCCs
+		__m512i z = Not ? _mm512_xor_si512( x, _mm512_and_si512( x, y ) ) : _mm512_and_si512( x, y );
+		__mmask8 lanes = _mm512_test_epi64_mask( z, z );
+		if ( lanes != 0 ){
+			size_t lane = lowest( lanes );
+			return ( w + lane ) * 64 + lowest( combine<Not>( a[w + lane], b[w + lane] ) );
+		}
+	}
+	return scan<Not>( a, b, w, words, ~uint64_t( 0 ) );
+}
+
+__attribute__(( target( "avx512f" ) ))
+static void store_avx512( uint64_t *out, const uint64_t *a, const uint64_t *b, size_t words ){
+	size_t w = 0;
+	for ( ; w + 8 <= words; w += 8 )
+		_mm512_storeu_si512( out + w, _mm512_and_si512( _mm512_loadu_si512( a + w ), _mm512_loadu_si512( b + w ) ) );
+	store_scalar( out + w, a + w, b + w, words - w );
+}
+
+#endif
+
+// The kernels in use
+struct BitKernels{
+	const char *name;
+	size_t ( *count )( const uint64_t *, const uint64_t *, size_t );
+	bool ( *any )( const uint64_t *, const uint64_t *, size_t );
+	size_t ( *find_and )( const uint64_t *, const uint64_t *, size_t, size_t );
+	size_t ( *find_andnot )( const uint64_t *, const uint64_t *, size_t, size_t );
+	void ( *store )( uint64_t *, const uint64_t *, const uint64_t *, size_t );
+};
+
+static BitKernels pick_kernels(){
+	BitKernels k = { "scalar", count_scalar, any_scalar, find_scalar<false>, find_scalar<true>, store_scalar };
+#ifdef BITGRAPH_X86
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "avx512f" ) ){
+		BitKernels wide = { "avx512", __builtin_cpu_supports( "avx512vpopcntdq" ) ? count_avx512 : count_avx2, any_avx512,
+			find_avx512<false>, find_avx512<true>, store_avx512 };
+		k = wide;
+	}
+	else if ( __builtin_cpu_supports( "avx2" ) ){
+		BitKernels wide = { "avx2", count_avx2, any_avx2, find_avx2<false>, find_avx2<true>, store_avx2 };
+		k = wide;
+	}
+#endif
+	return k;
+}
+
+static const BitKernels kernels = pick_kernels();
+
+size_t and_count( const uint64_t *a, const uint64_t *b, size_t words ){ return kernels.count( a, b, words ); }
+
+bool and_any( const uint64_t *a, const uint64_t *b, size_t words ){ return kernels.any( a, b, words ); }
+
+size_t and_find( const uint64_t *a, const uint64_t *b, size_t from, size_t words ){ return kernels.find_and( a, b, from, words ); }
+
+size_t andnot_find( const uint64_t *a, const uint64_t *b, size_t from, size_t words ){ return kernels.find_andnot( a, b, from, words ); }
+
+void and_store( uint64_t *out, const uint64_t *a, const uint64_t *b, size_t words ){ kernels.store( out, a, b, words ); }
+
+const char *bit_kernels(){ return kernels.name; }
+
+BitGraph::BitGraph( const Graph &G ) : words( ( G.num_vertices() + 63 ) / 64 ), rows( G.num_vertices() * words, 0 ){
+	for ( Id v = 0; v < G.num_vertices(); ++v ){
+		uint64_t *r = rows.data() + v * words;
+		for ( Id w : G.neighs( v ) )
+			r[w / 64] |= uint64_t( 1 ) << ( w % 64 );
+	}
+}
+
+bool BitGraph::dense( const Graph &G, double density ){
+	double n = G.num_vertices();
+	return n > 1 && G.num_edges() > density * n * ( n - 1 ) / 2;
+}
\ No newline at end of file
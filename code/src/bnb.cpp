@@ -1,143 +1,705 @@
 #include "bnb.h"
 #include "simplex.h"
 #include "heuristic.h"
+#include "incumbent.h"
+#include "bounds.h"
+#include "containers.h"
+#include "stats.h"
+#include "timer.h"
 #include <algorithm>
 #include <numeric>
 #include <iomanip>
-#include <chrono>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
 
 using namespace std;
 
-using TimePoint = chrono::time_point<std::chrono::system_clock>;
-using SecondsDouble = chrono::duration<double>;
-
-// G		- The graph
-// S		- Set of vertices that are to be explored
-// uncov	- number of edges still uncovered
-// soln		- holds the local solution
-// opt		- holds the optimal solution
-// cutoff	- cutoff time in seconds
-// start	- starting time point of solver
-// ofs		- ofstream to write to trace
+// A subproblem of the search, given by the vertices taken on the way to it from the root
+// id		- unique ticket, so the worker that split it off can take it back
+// path		- vertices in the cover, in the order they were taken
+struct Task{
+	size_t id;
+	vector<Id> path;
+};
+
+// Work-stealing pool of tasks, one deque per worker
+// A worker pushes and pops at the back of its own deque, idle workers steal from the front of the others'
+// locks	- one per deque
+// pending	- tasks pushed but not finished yet
+// idle		- workers looking for a task
+// stopped	- set when the time is up, remaining tasks are dropped
+class TaskPool{
+private:
+	vector<deque<Task>> deques;
+	unique_ptr<mutex[]> locks;
+	atomic<size_t> pending, tickets;
+	atomic<unsigned> idle;
+	atomic<bool> stopped;
+
+	bool pop_back( unsigned t, Task &task ){
+		lock_guard<mutex> guard( locks[t] );
+		if ( deques[t].empty() )
+			return false;
+		task = move( deques[t].back() );
+		deques[t].pop_back();
+		return true;
+	}
+
+	bool pop_front( unsigned t, Task &task ){
+		lock_guard<mutex> guard( locks[t] );
+		if ( deques[t].empty() )
+			return false;
+		task = move( deques[t].front() );
+		deques[t].pop_front();
+		return true;
+	}
+
+public:
+	TaskPool( unsigned workers ) : deques( workers ), locks( new mutex[workers] ), pending( 0 ), tickets( 0 ), idle( 0 ), stopped( false ) {}
+
+	// Only worth splitting the search when somebody would pick the task up
+	bool hungry() const { return idle.load( memory_order_relaxed ) > 0; }
+
+	void stop(){ stopped = true; }
+
+	// Returns the ticket of the task
+	size_t push( unsigned t, vector<Id> path ){
+		Task task;
+		size_t id = task.id = tickets++;
+		task.path = move( path );
+		++pending;
+		lock_guard<mutex> guard( locks[t] );
+		deques[t].push_back( move( task ) );
+		return id;
+	}
+
+	// Take back the last task pushed by t, if nobody stole it yet
+	bool reclaim( unsigned t, size_t ticket ){
+		lock_guard<mutex> guard( locks[t] );
+		if ( deques[t].empty() || deques[t].back().id != ticket )
+			return false;
+		deques[t].pop_back();
+		--pending;
+		return true;
+	}
+
+	void done(){ --pending; }
+
+	// Next task for worker t, false once all tasks are done or the time is up
+	bool next( unsigned t, Task &task ){
+		++idle;
+		while ( !stopped ){
+			bool found = pop_back( t, task );
+			for ( unsigned i = 1; !found && i < deques.size(); ++i )
+				found = pop_front( ( t + i ) % deques.size(), task );
+			if ( found ){
+				--idle;
+				return true;
+			}
+			if ( pending == 0 )
+				break;
+			this_thread::yield();
+		}
+		--idle;
+		return false;
+	}
+};
+
+// Subgraph induced by the vertices of comp, without removed ones, local is scratch space of G's size
+static unique_ptr<Graph> component_graph( const Graph &G, const vector<Id> &comp, const vector<bool> &removed, vector<Id> &local ){
+	for ( Id i = 0; i < comp.size(); ++i )
+		local[comp[i]] = i;
+	vector<Id> offsets( comp.size() + 1, 0 ), adjacency;
+	for ( Id i = 0; i < comp.size(); ++i ){
+		for ( Id w : G.neighs( comp[i] ) )
+			if ( !removed[w] )
+				adjacency.push_back( local[w] );
+		offsets[i + 1] = adjacency.size();
+	}
+	vector<Id> weights;
+	if ( G.weighted() )
+		for ( Id v : comp )
+			weights.push_back( G.weight( v ) );
+	return unique_ptr<Graph>( new Graph( move( offsets ), move( adjacency ), G.filename, weights ) );
+}
+
+// How the branching vertex is chosen, see known_rule
+enum class Rule{
+	MAXDEG, DENSITY, MIRROR
+};
+
+static Rule parse_rule( const string &rule ){
+	return rule == "density" ? Rule::DENSITY : rule == "mirror" ? Rule::MIRROR : Rule::MAXDEG;
+}
+
+// G			- The graph, shared by all workers
+// bydeg		- vertices by degree in the remaining graph, taken vertices are kept at 0
+// removed		- vertices taken into soln, their edges are gone from the graph
+// deg			- degree of each vertex in the remaining graph
+// uncov		- number of edges still uncovered
+// lb			- lower bound on the cover of the remaining graph, follows take/untake, lb_name says which
+// soln			- taken vertices in order, doubles as the undo trail and as the path of a task
+// cost			- weight of soln, its size if the graph is unweighted
+// pending		- vertices whose degree dropped to 2 or less since the last reduce()
+// rule			- how the branching vertex is chosen
+// mark, stamp	- stamps for neighborhood tests, two sets of marks can be live at once
+// local		- index of each vertex within the component being split off
+// scratch		- vertex lists of the nodes on the current path, each node pops its own before it returns
+// rest			- scratch of mirrors()
+// comps		- scratch of decompose(), the first ones are the components it found, the rest keep their storage
+// opt			- best solution of this worker, the overall best is the one of incumbent.best_thread()
+// cutoff		- cutoff time in seconds
+// start		- starting time point of the run
+// deadline		- cutoff seconds after start, asked at every node
+// incumbent	- weight of the best solution of all workers, used for pruning, null for a component of a node
+// pool			- tasks of all workers, null if the search is not shared
+// total		- for a component solved on its own, the weight of the best covers of all components summed
+// shared		- for a component searched by several workers, the weight of the best cover any of them found
+// ub			- weight of opt, the bound for pruning unless incumbent is about this graph or shared is set
+// thread		- index of this worker
+// base			- depth of the node whose component this solver searches, 0 unless it was split off by decompose()
+// own			- counters of this solver, unless it counts into those of the solver or worker it runs for
+// stats		- search nodes visited, nodes cut off by the lower bound and deepest node, counted as they happen
+//				  so the sampler sees nested solvers at work
 class BnBSolver{
 private:
-	Graph &G;
-	vector<Id> soln, opt;
-	unordered_set<Id> S;
-	Id uncov;
+	const Graph &G;
+	vector<Id> soln, opt, pending;
+	BucketQueue<Id> bydeg;
+	vector<bool> removed;
+	vector<Id> deg;
+	Id uncov, cost;
+	unique_ptr<LowerBound> lb;
+	string lb_name;
+	Rule rule;
+	vector<unsigned> mark[2];
+	unsigned stamp[2];
+	vector<Id> local;
+	ScratchStack<Id> scratch;
+	vector<Id> rest;
+	vector<vector<Id>> comps;
 	double cutoff;
 	TimePoint start;
-	ofstream ofs;
+	Deadline deadline;
+	Incumbent *incumbent;
+	TaskPool *pool;
+	atomic<size_t> *total, *shared;
+	size_t ub;
+	unsigned thread, base;
+	unique_ptr<Counters> own;
 
 public:
-	BnBSolver( Graph &G_, double cutoff_ ): G(G_), uncov( G.edges.size() ), cutoff( cutoff_ ){
+	enum { NODES, PRUNED, MAX_DEPTH };
+	Counters &stats;
+
+	// limit	- only covers smaller than this are of interest, best() stays empty if there are none
+	// counts	- counters to count into, null for counters of its own, sampled if there is an incumbent
+	BnBSolver( const Graph &G_, double cutoff_, const string &bound, Rule rule_, TimePoint start_, Incumbent *incumbent_, TaskPool *pool_,
+		unsigned thread_, atomic<size_t> *total_ = nullptr, size_t limit = static_cast<size_t>( -1 ), atomic<size_t> *shared_ = nullptr,
+		Counters *counts = nullptr, unsigned base_ = 0 )
+		: G( G_ ), uncov( G.num_edges() ), cost( 0 ), lb_name( bound ), rule( rule_ ), cutoff( cutoff_ ), start( start_ ), deadline( start_, cutoff_ ),
+		incumbent( incumbent_ ), pool( pool_ ),
+		total( total_ ), shared( shared_ ), ub( limit ), thread( thread_ ), base( base_ ),
+		own( counts ? nullptr : new Counters( "BnB " + to_string( thread_ ), { "nodes", "pruned", "max_depth" }, incumbent_ != nullptr ) ),
+		stats( counts ? *counts : *own ){
+		// Initial solution
+		vector<Id> all( G.num_vertices() );
+		for ( Id i = 0; i < G.num_vertices(); ++i )
+			all[i] = i;
+		if ( G.weight( all ) < ub ){
+			ub = G.weight( all );
+			opt.swap( all );
+		}
+
+		removed.assign( G.num_vertices(), false );
+		deg.resize( G.num_vertices() );
+		for ( Id i = 0; i < G.num_vertices(); ++i )
+			deg[i] = G.degree( i );
+		bydeg = BucketQueue<Id>( deg );
+		lb = make_bound( bound, G, removed, &deadline );
+		for ( int i = 0; i < 2; ++i ){
+			mark[i].assign( G.num_vertices(), 0 );
+			stamp[i] = 0;
+		}
+	}
+
+	// The only neighbor of v that is still in the graph
+	Id last_neigh( Id v ){
+		for ( Id w : G.neighs( v ) )
+			if ( !removed[w] )
+				return w;
+		return v;
+	}
+
+	// Add u to the solution and erase its edges from the graph, no need to delete the vertex itself though
+	void take( Id u ){
+		soln.push_back( u );
+		cost += G.weight( u );
+		removed[u] = true;
+		bydeg.set( u, 0 );
+		for ( Id v : G.neighs( u ) ){
+			if ( removed[v] )
+				continue;
+			--uncov;
+			bydeg.decrement( v );
+			if ( --deg[v] != 0 && deg[v] <= 2 )
+				pending.push_back( v );
+		}
+		lb->take( u );
+	}
+
+	// Restore graph and solution
+	void untake( Id u ){
+		lb->untake( u );
+		removed[u] = false;
+		for ( Id v : G.neighs( u ) ){
+			if ( removed[v] )
+				continue;
+			++uncov;
+			++deg[v];
+			bydeg.increment( v );
+		}
+		bydeg.set( u, deg[u] );
+		cost -= G.weight( u );
+		soln.pop_back();
+	}
+
+	// Weight to beat
+	size_t upper() const { return incumbent && !total ? incumbent->size() : shared ? shared->load( memory_order_relaxed ) : ub; }
+
+	// weight	- of cover
+	void improve( const vector<Id> &cover, size_t weight ){
+		if ( weight >= upper() )
+			return;
+		if ( incumbent && !total ){
+			if ( incumbent->offer( weight, thread ) )
+				opt = cover;
+			return;
+		}
+		if ( total ){
+			size_t old = ub;
+			if ( shared ){
+				old = shared->load();
+				while ( weight < old && !shared->compare_exchange_weak( old, weight ) ){}
+				if ( weight >= old )
+					return;
+			}
+			size_t gain = old - weight;
+			incumbent->offer( total->fetch_sub( gain ) - gain, thread );
+		}
+		ub = weight;
+		opt = cover;
+	}
+
+	// Fresh stamp i, every vertex unmarked
+	unsigned next_stamp( int i ){
+		if ( ++stamp[i] == 0 ){
+			fill( mark[i].begin(), mark[i].end(), 0 );
+			stamp[i] = 1;
+		}
+		return stamp[i];
+	}
+
+	// Number of edges among the neighbors of u
+	size_t neighborhood_edges( Id u ){
+		unsigned s = next_stamp( 0 );
+		for ( Id w : G.neighs( u ) )
+			if ( !removed[w] )
+				mark[0][w] = s;
+		size_t edges = 0;
+		for ( Id w : G.neighs( u ) ){
+			if ( removed[w] )
+				continue;
+			for ( Id x : G.neighs( w ) )
+				edges += mark[0][x] == s;
+		}
+		return edges / 2;
+	}
+
+	// Vertices x at distance 2 from u such that N( u ) - N( x ) is a clique
+	// Some minimum cover either contains N( u ), or contains u together with all its mirrors, so the branch that takes u takes them with it
+	// They are pushed on scratch
+	void mirrors( Id u ){
+		unsigned nu = next_stamp( 0 ), seen = next_stamp( 1 );
+		for ( Id w : G.neighs( u ) )
+			if ( !removed[w] )
+				mark[0][w] = nu;
+		mark[1][u] = seen;
+		for ( Id w : G.neighs( u ) ){
+			if ( removed[w] )
+				continue;
+			for ( Id x : G.neighs( w ) ){
+				if ( removed[x] || mark[0][x] == nu || mark[1][x] == seen )
+					continue;
+				mark[1][x] = seen;
+				// N( u ) - N( x )
+				rest.clear();
+				for ( Id y : G.neighs( u ) )
+					if ( !removed[y] && !G.adjacent( x, y ) )
+						rest.push_back( y );
+				bool clique = true;
+				for ( size_t i = 0; clique && i < rest.size(); ++i )
+					for ( size_t j = i + 1; clique && j < rest.size(); ++j )
+						clique = G.adjacent( rest[i], rest[j] );
+				if ( clique )
+					scratch.push( x );
+			}
+		}
+	}
+
+	// Branching vertex, a max degree one
+	// density breaks ties by the sparsest neighborhood, looking at a bounded number of the tied vertices
+	Id choose(){
+		Id u = bydeg.top();
+		if ( rule != Rule::DENSITY )
+			return u;
+		size_t best = neighborhood_edges( u ), tries = 0;
+		for ( const Id *it = bydeg.begin( deg[u] ); it != bydeg.end( deg[u] ) && ++tries <= 16; ++it ){
+			size_t edges = neighborhood_edges( *it );
+			if ( edges < best ){
+				best = edges;
+				u = *it;
+			}
+		}
+		return u;
+	}
+
+	// Untake back to a trail length
+	void undo( size_t mark ){
+		while ( soln.size() > mark )
+			untake( soln.back() );
+	}
+
+	// Degree-1 and degree-2 triangle rules until neither applies, isolated vertices are never live
+	// On a weighted graph a rule only fires if the vertices it takes weigh no more than the one they replace
+	// Folding a degree-2 vertex would change the graph under the lower bounds, so those are left to branching
+	void reduce(){
+		while ( !pending.empty() ){
+			Id v = pending.back();
+			pending.pop_back();
+			if ( removed[v] || deg[v] == 0 || deg[v] > 2 )
+				continue;
+			if ( deg[v] == 1 ){
+				Id a = last_neigh( v );
+				if ( G.weight( a ) <= G.weight( v ) )
+					take( a );
+				continue;
+			}
+			Id a = last_neigh( v ), b = a;
+			for ( Id w : G.neighs( v ) )
+				if ( !removed[w] && w != a )
+					b = w;
+			if ( G.adjacent( a, b ) && max( G.weight( a ), G.weight( b ) ) <= G.weight( v ) ){
+				take( a );
+				take( b );
+			}
+		}
+	}
+
+	// If the graph left has fallen apart, solve the components one by one and combine them, true if that settled the node
+	// Smallest first, each must beat what the bound leaves after the ones solved and one vertex for every other one,
+	// which on a weighted graph may weigh nothing
+	// depth	- of the node
+	bool decompose( unsigned depth ){
+		const Id *first = bydeg.begin( 1 ), *last = bydeg.end( bydeg.top_key() );
+		size_t count = 0;
+		unsigned s = next_stamp( 1 );
+		for ( const Id *it = first; it != last; ++it ){
+			if ( mark[1][*it] == s )
+				continue;
+			if ( count == comps.size() )
+				comps.emplace_back();
+			vector<Id> &comp = comps[count++];
+			comp.assign( 1, *it );
+			mark[1][*it] = s;
+			for ( size_t i = 0; i < comp.size(); ++i )
+				for ( Id w : G.neighs( comp[i] ) )
+					if ( !removed[w] && mark[1][w] != s ){
+						mark[1][w] = s;
+						comp.push_back( w );
+					}
+			if ( comp.size() == static_cast<size_t>( last - first ) )
+				return false;
+		}
+		sort( comps.begin(), comps.begin() + count, []( const vector<Id> &a, const vector<Id> &b ){
+			return a.size() < b.size();
+		} );
+
+		local.resize( G.num_vertices() );
+		vector<Id> cover( soln );
+		size_t weight = cost;
+		for ( size_t c = 0; c < count; ++c ){
+			const vector<Id> &comp = comps[c];
+			size_t need = weight + ( G.weighted() ? 0 : count - c - 1 );
+			if ( need + ( G.weighted() ? 0 : 1 ) >= upper() ){
+				stats.add( PRUNED );
+				return true;
+			}
+			unique_ptr<Graph> H = component_graph( G, comp, removed, local );
+			BnBSolver part( *H, cutoff, lb_name, rule, start, nullptr, nullptr, thread, nullptr, upper() - need, nullptr, &stats, base + depth );
+			part.run( Task() );
+			if ( part.best().empty() )
+				return true;
+			for ( Id v : part.best() )
+				cover.push_back( comp[v] );
+			weight += H->weight( part.best() );
+		}
+		improve( cover, weight );
+		return true;
 	}
 
-	void branch(){
-		TimePoint end = chrono::system_clock::now();
-		SecondsDouble elapsed_seconds = end - start;
-		if ( elapsed_seconds.count() > cutoff )
+	// checked	- edges left when the graph was last looked at for components on the way here
+	// depth	- branchings on the way here
+	void branch( Id checked = static_cast<Id>( -1 ), unsigned depth = 0 ){
+		stats.add( NODES );
+		stats.raise( MAX_DEPTH, base + depth );
+		if ( deadline.expired() ){
+			if ( pool )
+				pool->stop();
+			pending.clear();
 			return;
+		}
+		size_t mark = soln.size();
+		reduce();
+
 		// Recursion exit condition. All covered
 		if ( uncov == 0 ){
-			if ( soln.size() < opt.size() ){
-				opt = soln;
-				ofs << elapsed_seconds.count() << ',' << opt.size() << '\n';
-			}
+			improve( soln, cost );
+			undo( mark );
 			return;
 		}
 
 		// Is it worth going further? Check lower bound
-		// Use worse algorithm, because it gives better lower bound. (We want higher number)
-		// THis is why ---> H/2 <= OPT <= H <= 2OPT
-		vector<Id> x = greedybad( G );
-		size_t low = x.size() / 2;
-		if ( soln.size() + low >= opt.size() || low > S.size() )
+		if ( cost + lb->bound() >= upper() ){
+			stats.add( PRUNED );
+			undo( mark );
 			return;
+		}
 
-		// Get next considered vertex
-		Id u = *max_element( S.begin(), S.end(),
-							 [&]( Id a, Id b ){
-			return G.vertices[a].neighs.size() < G.vertices[b].neighs.size();
-		} );
-		S.erase( u );
-
-		////////////////////////////////////////////////////////////////////////////////////
-		// Case 1: Add it to the solution
-		// Skip this case if u has degree 0 or 1, but its neighbor has more than 1 degree
-		if ( !G.vertices[u].neighs.empty() && !( G.vertices[u].neighs.size() == 1 && G.vertices[*G.vertices[u].neighs.begin()].neighs.size() > 1 ) ){
-			soln.push_back( u );
-			// Erase edges from graph, no need to delete the vertex itself though
-			for ( Id v : G.vertices[u].neighs ){
-				G.edges.erase( edge( u, v ) );
-				G.vertices[v].neighs.erase( u );
-				--uncov;
+		// Look for components again once a quarter of the edges is gone since the last look
+		if ( uncov <= checked - checked / 4 ){
+			checked = uncov;
+			if ( decompose( depth ) ){
+				undo( mark );
+				return;
 			}
-			auto backup = move( G.vertices[u].neighs );
-			G.vertices[u].neighs.clear();
-			// Branch
-			branch();
-			// Restore graph and solution
-			G.vertices[u].neighs = move( backup );
-			for ( Id v : G.vertices[u].neighs ){
-				G.edges[edge( u, v )] = false;
-				G.vertices[v].neighs.insert( u );
-				++uncov;
+		}
+
+		// Get next considered vertex, case 1 takes it and its mirrors, scratch[first, neighs)
+		Id u = choose();
+		size_t first = scratch.top();
+		scratch.push( u );
+		if ( rule == Rule::MIRROR )
+			mirrors( u );
+
+		// Case 2 takes all neighbors of u, scratch[neighs, end), only worth it if that can still beat the incumbent
+		size_t neighs = scratch.top();
+		size_t weight = cost;
+		for ( Id w : G.neighs( u ) )
+			if ( !removed[w] ){
+				scratch.push( w );
+				weight += G.weight( w );
 			}
-			soln.pop_back();
+		if ( weight >= upper() )
+			scratch.pop( neighs );
+		size_t end = scratch.top();
+
+		// Hand case 2 to an idle worker, unless we are back before it got stolen
+		bool split = end != neighs && pool && pool->hungry();
+		size_t ticket = 0;
+		if ( split ){
+			vector<Id> path( soln );
+			for ( size_t i = neighs; i < end; ++i )
+				path.push_back( scratch[i] );
+			ticket = pool->push( thread, move( path ) );
 		}
-		////////////////////////////////////////////////////////////////////////////////////
-		// Case 2: Don't add it to the solution
-		branch();
 
-		// Insert it back to considered vertices
-		S.insert( u );
+		////////////////////////////////////////////////////////////////////////////////////
+		// Case 1: Add it to the solution, with its mirrors
+		for ( size_t i = first; i < neighs; ++i )
+			take( scratch[i] );
+		branch( checked, depth + 1 );
+		undo( soln.size() - ( neighs - first ) );
+		////////////////////////////////////////////////////////////////////////////////////
+		// Case 2: Don't add it to the solution, so all its neighbors are in
+		if ( end != neighs && ( !split || pool->reclaim( thread, ticket ) ) ){
+			for ( size_t i = neighs; i < end; ++i )
+				take( scratch[i] );
+			branch( checked, depth + 1 );
+		}
+		scratch.pop( first );
+		undo( mark );
 	}
 
-	vector<Id> solve(){
-		ostringstream oss;
-		oss << "output/" << G.filename.substr( 0, G.filename.size() - 6u ) << "_BnB_" << cutoff;
-		
-		// Solve
-		start = chrono::system_clock::now();
-
-		// Initial solution
-		opt.reserve( G.vertices.size() );
-		for ( Id i = 0; i < G.vertices.size(); ++i )
-			opt.push_back( i );
-
-		// Open trace ofstream
-		ofs.open( oss.str() + ".trace" );
-		TimePoint end = chrono::system_clock::now();
-		SecondsDouble time_elapsed = end - start;
-		ofs << time_elapsed.count() << ',' << opt.size() << '\n';
-
-		// Initialize vertices to be explored
-		S.reserve( G.vertices.size() );
-		for ( Id i = 0; i < G.vertices.size(); ++i )
-			if ( G.vertices[i].neighs.size() > 1 )
-				S.insert( i );
+	// Search the subproblem of a task, then undo its path to get back to the root
+	void run( const Task &task ){
+		for ( Id v : task.path )
+			take( v );
+		pending.clear();
+		for ( size_t d = 1; d <= 2 && d <= bydeg.top_key(); ++d )
+			pending.insert( pending.end(), bydeg.begin( d ), bydeg.end( d ) );
 		branch();
+		undo( 0 );
+	}
 
-		// Close trace ofstream
-		ofs.close();
-
-		// Write best solution found
-		ofstream solfs( oss.str() + ".sol" );
-		solfs << opt.size() << '\n';
-		for ( size_t i = 0; i < opt.size(); ++i ){
-			if ( i != 0 )
-				solfs << ',';
-			solfs << ( opt[i] + 1 );
+	void solve(){
+		Task task;
+		while ( pool->next( thread, task ) ){
+			run( task );
+			pool->done();
 		}
+	}
 
-		return opt;
+	// Start from a known cover, if it beats the one there is
+	void seed( const vector<Id> &cover ){
+		if ( G.weight( cover ) < ub ){
+			ub = G.weight( cover );
+			opt = cover;
+		}
 	}
+
+	const vector<Id> &best() const { return opt; }
 };
 
-void branch_and_bound( Graph &G, int cutoff ){
-	BnBSolver solver( G, cutoff );
-	vector<Id> VC = solver.solve();
+unique_ptr<Kernel> solve_small_components( const Graph &G, Id small, int cutoff ){
+	TimePoint start = Clock::now();
+	unique_ptr<Kernel> K( new Kernel );
+	K->input_size = G.num_vertices();
+	vector<bool> none( G.num_vertices(), false );
+	vector<Id> local( G.num_vertices() );
+	for ( const vector<Id> &comp : G.components() ){
+		if ( comp.size() > small ){
+			K->original.insert( K->original.end(), comp.begin(), comp.end() );
+			continue;
+		}
+		unique_ptr<Graph> H = component_graph( G, comp, none, local );
+		BnBSolver part( *H, cutoff, "matching", Rule::MAXDEG, start, nullptr, nullptr, 0 );
+		part.run( Task() );
+		for ( Id v : part.best() )
+			K->forced.push_back( comp[v] );
+		K->heavy += H->weight( part.best() ) - part.best().size();
+	}
+	// Ascending, so the kernel keeps sorted neighbor lists
+	sort( K->original.begin(), K->original.end() );
+	K->graph.reset( new Graph( G, K->original ) );
+	K->seconds = seconds_since( start );
+	return K;
+}
+
+bool known_rule( const string &rule ){
+	return rule == "maxdeg" || rule == "density" || rule == "mirror";
+}
+
+vector<Id> branch_and_bound( const Graph &G, int cutoff, unsigned threads, const string &bound, const string &rule, const Kernel *kernel ){
+	TimePoint start = Clock::now();
+	threads = max( 1u, threads );
+	Rule branching = parse_rule( rule );
+	ostringstream oss;
+	oss << "output/" << G.filename.substr( 0, G.filename.size() - 6u ) << "_BnB_" << cutoff;
+	Incumbent incumbent( oss.str(), start, kernel );
+	// A heuristic cover to beat from the start, so that the bound can prune near the root
+	vector<Id> initial = G.weighted() ? primal_dual( G ) : parallel_greedy( G, threads );
+	incumbent.offer( G.weight( initial ), 0 );
+
+	unsigned long long nodes = 0, pruned = 0, depth = 0;
+	vector<Id> VC;
+	vector<vector<Id>> comps = G.components();
+	if ( comps.size() > 1 ){
+		// Components are searched on their own and their covers summed
+		// One with more than a worker's share of the vertices is searched by all workers through a task pool,
+		// the others go to one worker each, largest first to spread them out
+		cout << "BnB: " << comps.size() << " components, the largest has " << comps.back().size() << " vertices\n";
+		atomic<size_t> total( 0 ), next( 0 );
+		// The initial cover of each component, in its own numbering, in the order they are searched
+		vector<bool> in( G.num_vertices(), false );
+		for ( Id v : initial )
+			in[v] = true;
+		vector<vector<Id>> seeds( comps.size() );
+		for ( size_t c = 0; c < comps.size(); ++c ){
+			const vector<Id> &comp = comps[comps.size() - 1 - c];
+			for ( Id i = 0; i < comp.size(); ++i )
+				if ( in[comp[i]] ){
+					seeds[c].push_back( i );
+					total += G.weight( comp[i] );
+				}
+		}
+		incumbent.offer( total, 0 );
+		vector<vector<Id>> covers( comps.size() );
+		// The solvers of the components a worker searches count into its counters
+		vector<unique_ptr<Counters>> counts;
+		for ( unsigned t = 0; t < threads; ++t )
+			counts.emplace_back( new Counters( "BnB " + to_string( t ), { "nodes", "pruned", "max_depth", "components" } ) );
+		vector<bool> none( G.num_vertices(), false );
+		vector<Id> local( G.num_vertices() );
+		for ( ; next < comps.size() && comps[comps.size() - 1 - next].size() * threads > G.num_vertices(); ++next ){
+			const vector<Id> &comp = comps[comps.size() - 1 - next];
+			unique_ptr<Graph> H = component_graph( G, comp, none, local );
+			TaskPool pool( threads );
+			atomic<size_t> best( H->weight( seeds[next] ) );
+			vector<unique_ptr<BnBSolver>> workers;
+			for ( unsigned t = 0; t < threads; ++t )
+				workers.emplace_back( new BnBSolver( *H, cutoff, bound, branching, start, &incumbent, &pool, t, &total, static_cast<size_t>( -1 ), &best,
+					counts[t].get() ) );
+			workers[0]->seed( seeds[next] );
+			pool.push( 0, vector<Id>() );
+			parallel_for( threads, threads, [&]( unsigned, size_t b, size_t e ){
+				for ( size_t t = b; t < e; ++t )
+					workers[t]->solve();
+			} );
+			const BnBSolver *winner = workers[0].get();
+			for ( const unique_ptr<BnBSolver> &w : workers )
+				if ( H->weight( w->best() ) < H->weight( winner->best() ) )
+					winner = w.get();
+			for ( Id v : winner->best() )
+				covers[next].push_back( comp[v] );
+			counts[0]->add( 3 );
+		}
+		parallel_for( threads, threads, [&]( unsigned, size_t b, size_t e ){
+			vector<bool> none( G.num_vertices(), false );
+			vector<Id> local( G.num_vertices() );
+			for ( size_t t = b; t < e; ++t )
+				for ( size_t c; ( c = next++ ) < comps.size(); ){
+					const vector<Id> &comp = comps[comps.size() - 1 - c];
+					unique_ptr<Graph> H = component_graph( G, comp, none, local );
+					BnBSolver part( *H, cutoff, bound, branching, start, &incumbent, nullptr, t, &total, static_cast<size_t>( -1 ), nullptr,
+						counts[t].get() );
+					part.seed( seeds[c] );
+					part.run( Task() );
+					for ( Id v : part.best() )
+						covers[c].push_back( comp[v] );
+					counts[t]->add( 3 );
+				}
+		} );
+		for ( const unique_ptr<Counters> &c : counts ){
+			nodes += c->get( BnBSolver::NODES );
+			pruned += c->get( BnBSolver::PRUNED );
+			depth = max( depth, c->get( BnBSolver::MAX_DEPTH ) );
+		}
+		for ( const vector<Id> &cover : covers )
+			VC.insert( VC.end(), cover.begin(), cover.end() );
+	}
+	else{
+		TaskPool pool( threads );
+		vector<unique_ptr<BnBSolver>> workers;
+		for ( unsigned t = 0; t < threads; ++t )
+			workers.emplace_back( new BnBSolver( G, cutoff, bound, branching, start, &incumbent, &pool, t ) );
+		workers[0]->seed( initial );
+		pool.push( 0, vector<Id>() );
+		parallel_for( threads, threads, [&]( unsigned, size_t b, size_t e ){
+			for ( size_t t = b; t < e; ++t )
+				workers[t]->solve();
+		} );
+		for ( const unique_ptr<BnBSolver> &w : workers ){
+			nodes += w->stats.get( BnBSolver::NODES );
+			pruned += w->stats.get( BnBSolver::PRUNED );
+			depth = max( depth, w->stats.get( BnBSolver::MAX_DEPTH ) );
+		}
+		VC = workers[incumbent.best_thread()]->best();
+	}
+	cout << "BnB: " << nodes << " nodes (" << nodes / max( seconds_since( start ), 1e-9 ) << " nodes/s), "
+		<< pruned << " pruned by the " << bound << " bound (" << 100.0 * pruned / max( nodes, 1ull ) << "%), max depth " << depth << '\n';
 
-	G.check_coverage( VC );
+	return incumbent.write_solution( VC );
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "bounds.h"
+#include "heuristic.h"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+// Greedy maximal matching of the graph without the removed vertices, num_vertices() marks unmatched ones
+// Low degree vertices go first since they have the fewest chances
+static vector<Id> greedy_matching( const Graph &G, const vector<bool> &removed ){
+	Id N = G.num_vertices();
+	vector<Id> mate( N, N );
+	vector<Id> order( N );
+	iota( order.begin(), order.end(), 0 );
+	sort( order.begin(), order.end(), [&]( Id a, Id b ){
+		return G.degree( a ) < G.degree( b );
+	} );
+	for ( Id u : order ){
+		if ( removed[u] || mate[u] != N )
+			continue;
+		Id best = N;
+		for ( Id v : G.neighs( u ) )
+			if ( !removed[v] && mate[v] == N && ( best == N || G.degree( v ) < G.degree( best ) ) )
+				best = v;
+		if ( best != N ){
+			mate[u] = best;
+			mate[best] = u;
+		}
+	}
+	return mate;
+}
+
+MatchingBound::MatchingBound( const Graph &G_, const vector<bool> &removed_ )
+	: G( G_ ), removed( removed_ ), mate( greedy_matching( G, removed ) ), matched( 0 ){
+	for ( Id u = 0; u < G.num_vertices(); ++u )
+		if ( mate[u] < u )
+			matched += min( G.weight( u ), G.weight( mate[u] ) );
+}
+
+void MatchingBound::set_mate( Id u, Id v ){
+	trail.push_back( make_pair( u, mate[u] ) );
+	mate[u] = v;
+}
+
+void MatchingBound::take( Id u ){
+	Id N = G.num_vertices();
+	marks.push_back( make_pair( trail.size(), matched ) );
+	Id v = mate[u];
+	if ( v == N )
+		return;
+	set_mate( u, N );
+	set_mate( v, N );
+	matched -= min( G.weight( u ), G.weight( v ) );
+	// v is the only vertex that may have a free neighbor now
+	for ( Id w : G.neighs( v ) )
+		if ( !removed[w] && mate[w] == N ){
+			set_mate( v, w );
+			set_mate( w, v );
+			matched += min( G.weight( v ), G.weight( w ) );
+			break;
+		}
+}
+
+void MatchingBound::untake( Id ){
+	for ( size_t i = trail.size(); i-- > marks.back().first; )
+		mate[trail[i].first] = trail[i].second;
+	trail.resize( marks.back().first );
+	matched = marks.back().second;
+	marks.pop_back();
+}
+
+size_t GreedyBound::bound(){
+	// Use worse algorithm, because it gives better lower bound. (We want higher number)
+	// THis is why ---> H/2 <= OPT <= H <= 2OPT
+	return greedybad( G, removed, scratch ).size() / 2;
+}
+
+static vector<double> vertex_weights( const Graph &G ){
+	vector<double> w( G.num_vertices() );
+	for ( Id v = 0; v < G.num_vertices(); ++v )
+		w[v] = G.weight( v );
+	return w;
+}
+
+LPBound::LPBound( const Graph &G_, const vector<bool> &removed_, Deadline *deadline_ )
+	: G( G_ ), removed( removed_ ), lp( vertex_weights( G ) ), max_iter( 32 ), deadline( deadline_ ){
+	vector<pair<size_t, double>> column( 2 );
+	for ( Id e = 0; e < G.num_edges(); ++e ){
+		column[0] = make_pair( G.edges[e].first, 1.0 );
+		column[1] = make_pair( G.edges[e].second, 1.0 );
+		lp.add_column( removed[G.edges[e].first] || removed[G.edges[e].second] ? 0.0 : 1.0, column );
+	}
+
+	// Start from a greedy matching, y_e = 1 on its edges, which saves the simplex most of its pivots
+	// With weights y_e is the weight of the lighter end, whose row is the one that becomes tight
+	vector<Id> mate = greedy_matching( G, removed );
+	vector<pair<size_t, size_t>> basis;
+	for ( Id u = 0; u < G.num_vertices(); ++u )
+		if ( mate[u] < u )
+			basis.push_back( make_pair( G.edge_id( u, mate[u] ), G.weight( u ) <= G.weight( mate[u] ) ? u : mate[u] ) );
+	lp.crash( basis );
+}
+
+void LPBound::take( Id u ){
+	marks.push_back( trail.size() );
+	for ( Id e : G.incident( u ) )
+		if ( lp.get_cost( e ) != 0.0 ){
+			lp.set_cost( e, 0.0 );
+			trail.push_back( e );
+		}
+}
+
+void LPBound::untake( Id ){
+	for ( size_t i = marks.back(); i < trail.size(); ++i )
+		lp.set_cost( trail[i], 1.0 );
+	trail.resize( marks.back() );
+	marks.pop_back();
+}
+
+size_t LPBound::bound(){
+	lp.solve( max_iter, deadline );
+	return static_cast<size_t>( ceil( lp.objective() - 1.0e-6 ) );
+}
+
+bool known_bound( const string &name ){
+	return name == "matching" || name == "greedy" || name == "lp";
+}
+
+unique_ptr<LowerBound> make_bound( const string &name, const Graph &G, const vector<bool> &removed, Deadline *deadline ){
+	if ( name == "matching" )
+		return unique_ptr<LowerBound>( new MatchingBound( G, removed ) );
+	if ( name == "greedy" )
+		return unique_ptr<LowerBound>( new GreedyBound( G, removed ) );
+	if ( name == "lp" )
+		return unique_ptr<LowerBound>( new LPBound( G, removed, deadline ) );
+	return nullptr;
+}
\ No newline at end of file
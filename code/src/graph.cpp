@@ -1,59 +1,464 @@
 #include "graph.h"
+#include "timer.h"
 #include <algorithm>
-#include <cassert>
 #include <string>
+#include <cstring>
+#include <cstdint>
 
-// Hash function for Edge pair. This only works if vertex id bits fit into half of unsigned long long
-namespace std {
-	size_t hash<Edge>::operator()( const Edge &name ) const
-	{
-		unsigned long long e = name.first;
-		// Shift it to left half of e. sizeof = num of bytes. 1 byte = 8 bit. Shift by half the amount
-		e |= static_cast<unsigned long long>( name.second ) << ( 4 * sizeof( unsigned long long ) );
-		return hash<unsigned long long>()( e );
+// Skip blanks and parse the next unsigned integer on the current line
+// Returns false, leaving p on the newline, if the line has no more numbers
+static inline bool parse_id( const char *&p, const char *end, Id &x ){
+	while ( p < end && ( *p < '0' || *p > '9' ) ){
+		if ( *p == '\n' )
+			return false;
+		++p;
 	}
+	if ( p == end )
+		return false;
+	x = 0;
+	while ( p < end && *p >= '0' && *p <= '9' )
+		x = x * 10 + static_cast<Id>( *p++ - '0' );
+	return true;
+}
+
+// Which of the optional METIS fields the lines carry, from the fmt and ncon values of the header
+// sizes	- a vertex size first, skipped
+// vweights	- this many vertex weights next, the first one is kept
+// eweights	- a weight after each neighbor, skipped
+struct LineFormat{
+	bool sizes;
+	Id vweights;
+	bool eweights;
 };
 
-Graph::Graph( string infile ){
-	char delim = find( infile.begin(), infile.end(), '\\' ) != infile.end() ? '\\' : '/';
-	auto path = split( infile, delim );
-	filename = path.back();
-	ifstream ifs( infile );
-	if ( !ifs.good() ){
+// Parse the adjacency lines in [p, end). Lines starting with '%' are comments.
+// adj	- neighbors of all parsed lines, 0-based
+// degs	- number of neighbors on each line
+// wts	- vertex weight of each line, if the format has them
+static void parse_lines( const char *p, const char *end, const LineFormat &fmt, vector<Id> &adj, vector<Id> &degs, vector<Id> &wts ){
+	while ( p < end ){
+		if ( *p != '%' ){
+			Id d = 0, j, w = 1;
+			if ( fmt.sizes )
+				parse_id( p, end, j );
+			for ( Id k = 0; k < fmt.vweights; ++k )
+				if ( parse_id( p, end, j ) && k == 0 )
+					w = j;
+			if ( fmt.vweights > 0 )
+				wts.push_back( w );
+			while ( parse_id( p, end, j ) ){
+				adj.push_back( j - 1 );
+				++d;
+				if ( fmt.eweights )
+					parse_id( p, end, j );
+			}
+			degs.push_back( d );
+		}
+		p = find( p, end, '\n' );
+		if ( p < end )
+			++p;
+	}
+}
+
+// Layout of a snapshot file: this header, then the degree of each vertex, the neighbor lists and, if weighted,
+// the weights. Each array is stored in the narrowest of 1, 2, 4 and 8 byte integers that holds its values,
+// in host byte order, and the whole is padded with zeros to a multiple of 8 bytes.
+// The edge numbering is not stored, it is rebuilt on load as for a parsed graph.
+// *_width				- bytes per value of each array
+// source_size/mtime	- stamp of the text file at dump time, a changed file makes the snapshot stale
+// checksum				- of the padded arrays following the header
+// The fields up to source keep their offsets across versions, so an old snapshot still names its text file
+struct SnapshotHeader{
+	char magic[8];
+	uint32_t version;
+	uint8_t degree_width, neighbor_width, weight_width, unused;
+	uint64_t n, m;
+	uint64_t weighted;
+	uint64_t source_size;
+	int64_t source_mtime;
+	uint64_t checksum;
+	char source[256];
+};
+
+static const char snapshot_magic[8] = { 'M', 'I', 'N', 'V', 'C', 'B', 'I', 'N' };
+static const uint32_t snapshot_version = 3;
+
+// Narrowest of 1, 2, 4 and 8 bytes that holds every value up to max
+static uint32_t int_width( uint64_t max ){
+	uint32_t width = 1;
+	while ( width < 8 && max >> ( 8 * width ) != 0 )
+		width *= 2;
+	return width;
+}
+
+template <class T>
+static void put_ints( vector<char> &out, const Id *first, const Id *last ){
+	size_t at = out.size();
+	out.resize( at + ( last - first ) * sizeof( T ) );
+	for ( ; first != last; ++first, at += sizeof( T ) ){
+		T x = static_cast<T>( *first );
+		memcpy( &out[at], &x, sizeof( T ) );
+	}
+}
+
+// Append [first, last) at width bytes per value
+static void put_ints( vector<char> &out, const Id *first, const Id *last, uint32_t width ){
+	switch ( width ){
+	case 1: put_ints<uint8_t>( out, first, last ); break;
+	case 2: put_ints<uint16_t>( out, first, last ); break;
+	case 4: put_ints<uint32_t>( out, first, last ); break;
+	default: put_ints<uint64_t>( out, first, last );
+	}
+}
+
+template <class T>
+static void get_ints( const char *p, vector<Id> &out ){
+	for ( size_t i = 0; i < out.size(); ++i, p += sizeof( T ) ){
+		T x;
+		memcpy( &x, p, sizeof( T ) );
+		out[i] = x;
+	}
+}
+
+// Read count values of width bytes into out, returns the end of them
+static const char *get_ints( const char *p, size_t count, uint32_t width, vector<Id> &out ){
+	out.resize( count );
+	switch ( width ){
+	case 1: get_ints<uint8_t>( p, out ); break;
+	case 2: get_ints<uint16_t>( p, out ); break;
+	case 4: get_ints<uint32_t>( p, out ); break;
+	default: get_ints<uint64_t>( p, out );
+	}
+	return p + count * width;
+}
+
+Graph::Graph( string infile, unsigned threads ){
+	TimePoint load_start = Clock::now();
+	unique_ptr<MappedFile> file( new MappedFile( infile ) );
+	if ( !file->good() ){
 		cout << "File could not be opened!\n";
 		exit(1);
 	}
+	size_t bytes = file->size();
+	source = infile;
+	if ( bytes >= sizeof( snapshot_magic ) && equal( snapshot_magic, snapshot_magic + 8, file->data() ) ){
+		if ( !load_snapshot( *file, threads ) ){
+			cout << "Snapshot " << infile << " is stale or corrupted";
+			file.reset( source == infile ? nullptr : new MappedFile( source ) );
+			if ( !file || !file->good() ){
+				cout << "!\n";
+				exit(1);
+			}
+			cout << ", parsing " << source << " instead\n";
+			bytes = file->size();
+			load_text( *file, threads );
+		}
+	}
+	else
+		load_text( *file, threads );
+
+	char delim = find( source.begin(), source.end(), '\\' ) != source.end() ? '\\' : '/';
+	auto path = split( source, delim );
+	filename = path.back();
+
+	double load_seconds = seconds_since( load_start );
+	double mb = bytes / 1.0e6;
+	cout << "Graph initialized! |V| = " << num_vertices() << ", |E| = " << num_edges() << ( weighted() ? ", weighted" : "" )
+		<< ", loaded " << mb << " MB in " << load_seconds << " s ("
+		<< mb / max( load_seconds, 1.0e-9 ) << " MB/s)\n";
+}
+
+void Graph::load_text( const MappedFile &file, unsigned threads ){
+	// One pass over the text, the file is dropped after it
+	file.sequential( true );
+	const char *p = file.data(), *end = p + file.size();
+
+	// Header: N M [fmt [ncon]], after any comment lines
+	// The fmt digits say whether lines have vertex sizes, vertex weights and edge weights, in that order
+	while ( p < end && *p == '%' )
+		p = min( end, find( p, end, '\n' ) + 1 );
+	Id N = 0, M = 0, W = 0, ncon = 1;
+	parse_id( p, end, N );
+	parse_id( p, end, M );
+	parse_id( p, end, W );
+	parse_id( p, end, ncon );
+	p = min( end, find( p, end, '\n' ) + 1 );
+	LineFormat fmt;
+	fmt.sizes = W / 100 % 10 == 1;
+	fmt.vweights = W / 10 % 10 == 1 ? max( ncon, Id( 1 ) ) : 0;
+	fmt.eweights = W % 10 == 1;
+
+	// Cut the body into chunks at line boundaries and parse them independently
+	threads = max( 1u, threads );
+	vector<const char *> cuts( threads + 1, end );
+	cuts[0] = p;
+	for ( unsigned t = 1; t < threads; ++t ){
+		const char *c = max( cuts[t - 1], p + ( end - p ) * t / threads );
+		cuts[t] = c == p ? p : min( end, find( c - 1, end, '\n' ) + 1 );
+	}
+	vector<vector<Id>> adjs( threads ), degs( threads ), wts( threads );
+	parallel_for( threads, threads, [&]( unsigned, size_t b, size_t e ){
+		for ( size_t t = b; t < e; ++t ){
+			if ( threads == 1 )
+				adjs[t].reserve( 2 * M );
+			parse_lines( cuts[t], cuts[t + 1], fmt, adjs[t], degs[t], wts[t] );
+		}
+	} );
 
-	Id N, M, W;
-	ifs >> N >> M >> W;
-	// Check if our edge data structure stupports this number of vertices
-	// unsigned -1 overflows, so we get max value
-	assert( N <= ( 1ull << ( sizeof( Id ) * 4 ) ) );
-	ifs.ignore();
-	vertices.resize( N );
+	// Lay the chunks out as CSR, lines past N are ignored and missing ones are empty
+	offsets_data.assign( N + 1, 0 );
+	vector<Id> firstvertex( threads + 1, 0 );
+	for ( unsigned t = 0; t < threads; ++t ){
+		firstvertex[t + 1] = firstvertex[t] + degs[t].size();
+		for ( size_t i = 0; i < degs[t].size() && firstvertex[t] + i < N; ++i )
+			offsets_data[firstvertex[t] + i + 1] = degs[t][i];
+	}
+	for ( Id i = 0; i < N; ++i )
+		offsets_data[i + 1] += offsets_data[i];
+	if ( fmt.vweights > 0 ){
+		weights_data.assign( N, 1 );
+		for ( unsigned t = 0; t < threads; ++t )
+			for ( size_t i = 0; i < wts[t].size() && firstvertex[t] + i < N; ++i )
+				weights_data[firstvertex[t] + i] = wts[t][i];
+	}
+	if ( threads == 1 ){
+		adjs[0].resize( offsets_data[N] );
+		adjacency_data.swap( adjs[0] );
+	}
+	else{
+		adjacency_data.resize( offsets_data[N] );
+		parallel_for( threads, threads, [&]( unsigned, size_t b, size_t e ){
+			for ( size_t t = b; t < e; ++t ){
+				if ( firstvertex[t] >= N )
+					continue;
+				size_t len = min( adjs[t].size(), static_cast<size_t>( offsets_data[N] - offsets_data[firstvertex[t]] ) );
+				copy( adjs[t].begin(), adjs[t].begin() + len, adjacency_data.begin() + offsets_data[firstvertex[t]] );
+				vector<Id>().swap( adjs[t] );
+			}
+		} );
+	}
+
+	build( threads );
+}
+
+Graph::Graph( const Graph &G, const vector<Id> &keep )
+	: filename( G.filename ), source( G.source ){
+	// New ids follow the order of keep, so sorted neighbor lists stay sorted if keep is
+	Id N = keep.size();
+	vector<Id> newid( G.num_vertices(), G.num_vertices() );
+	for ( Id i = 0; i < N; ++i )
+		newid[keep[i]] = i;
+	offsets_data.assign( N + 1, 0 );
 	for ( Id i = 0; i < N; ++i ){
-		string line;
-		getline( ifs, line );
-		auto neighs = split( line, ' ' );
-		for ( string &s : neighs ){
-			Id j = stoul( s );
-			vertices[i].neighs.insert( --j );
-			edges[edge(i, j)] = false;
+		for ( Id j : G.neighs( keep[i] ) )
+			if ( newid[j] != G.num_vertices() )
+				adjacency_data.push_back( newid[j] );
+		offsets_data[i + 1] = adjacency_data.size();
+	}
+	if ( G.weighted() )
+		for ( Id v : keep )
+			weights_data.push_back( G.weights[v] );
+	build( 1 );
+}
+
+Graph::Graph( const vector<vector<Id>> &lists, const string &filename_, const vector<Id> &weights_ )
+	: filename( filename_ ), weights_data( weights_ ){
+	offsets_data.assign( lists.size() + 1, 0 );
+	for ( size_t i = 0; i < lists.size(); ++i ){
+		adjacency_data.insert( adjacency_data.end(), lists[i].begin(), lists[i].end() );
+		offsets_data[i + 1] = adjacency_data.size();
+	}
+	build( 1 );
+}
+
+Graph::Graph( vector<Id> &&offsets_, vector<Id> &&adjacency_, const string &filename_, const vector<Id> &weights_ )
+	: filename( filename_ ), offsets_data( move( offsets_ ) ), adjacency_data( move( adjacency_ ) ), weights_data( weights_ ){
+	build( 1 );
+}
+
+void Graph::build( unsigned threads ){
+	Id N = offsets_data.size() - 1;
+
+	// Sort neighbor lists and count the edges each vertex is the smaller endpoint of
+	vector<Id> upper( N + 1, 0 );
+	parallel_for( threads, N, [&]( unsigned, size_t b, size_t e ){
+		for ( Id i = b; i < e; ++i ){
+			sort( adjacency_data.begin() + offsets_data[i], adjacency_data.begin() + offsets_data[i + 1] );
+			upper[i + 1] = adjacency_data.begin() + offsets_data[i + 1]
+				- upper_bound( adjacency_data.begin() + offsets_data[i], adjacency_data.begin() + offsets_data[i + 1], i );
 		}
+	} );
+	for ( Id i = 0; i < N; ++i )
+		upper[i + 1] += upper[i];
+
+	// Number edges in order of their smaller endpoint, the other direction looks the id up
+	// On one thread the smaller endpoints come in the order they have in the lists of the larger ones,
+	// so a cursor per list finds the other direction without a search
+	edge_ids_data.resize( adjacency_data.size() );
+	edges_data.resize( upper[N] );
+	if ( threads <= 1 || N < threads ){
+		vector<Id> next( offsets_data.begin(), offsets_data.end() - 1 );
+		Id id = 0;
+		for ( Id i = 0; i < N; ++i )
+			for ( Id k = offsets_data[i + 1] - ( upper[i + 1] - upper[i] ); k < offsets_data[i + 1]; ++k, ++id ){
+				Id j = adjacency_data[k];
+				edge_ids_data[k] = edge_ids_data[next[j]++] = id;
+				edges_data[id] = Edge( i, j );
+			}
 	}
-	cout << "Graph initialized! |V| = " << N << ", |E| = " << M << '\n';
+	else{
+		parallel_for( threads, N, [&]( unsigned, size_t b, size_t e ){
+			for ( Id i = b; i < e; ++i ){
+				Id id = upper[i];
+				for ( Id k = offsets_data[i + 1] - ( upper[i + 1] - upper[i] ); k < offsets_data[i + 1]; ++k ){
+					edge_ids_data[k] = id;
+					edges_data[id++] = Edge( i, adjacency_data[k] );
+				}
+			}
+		} );
+		parallel_for( threads, N, [&]( unsigned, size_t b, size_t e ){
+			for ( Id i = b; i < e; ++i ){
+				for ( Id k = offsets_data[i]; k < offsets_data[i + 1] - ( upper[i + 1] - upper[i] ); ++k ){
+					Id j = adjacency_data[k];
+					edge_ids_data[k] = edge_ids_data[lower_bound( adjacency_data.begin() + offsets_data[j], adjacency_data.begin() + offsets_data[j + 1], i ) - adjacency_data.begin()];
+				}
+			}
+		} );
+	}
+
+	offsets = offsets_data;
+	adjacency = adjacency_data;
+	edge_ids = edge_ids_data;
+	edges = edges_data;
+	weights = weights_data;
 }
 
-void Graph::check_coverage( vector<Id> &VC ){
+bool Graph::load_snapshot( const MappedFile &file, unsigned threads ){
+	if ( file.size() < sizeof( SnapshotHeader ) )
+		return false;
+	const SnapshotHeader *h = reinterpret_cast<const SnapshotHeader *>( file.data() );
+	if ( h->source[sizeof( h->source ) - 1] != '\0' )
+		return false;
+	source = h->source;
+	if ( h->version != snapshot_version )
+		return false;
+	for ( uint32_t width : { h->degree_width, h->neighbor_width, h->weight_width } )
+		if ( width != 1 && width != 2 && width != 4 && width != 8 )
+			return false;
+	size_t bytes = h->n * h->degree_width + 2 * h->m * h->neighbor_width + ( h->weighted ? h->n * h->weight_width : 0 );
+	if ( file.size() != sizeof( SnapshotHeader ) + ( bytes + 7 ) / 8 * 8 )
+		return false;
+
+	// Stale if the text file it was made from still exists but changed since
+	uint64_t size;
+	int64_t mtime;
+	if ( file_stamp( source, size, mtime ) && ( size != h->source_size || mtime != h->source_mtime ) )
+		return false;
+
+	// Read front to back once, the file is dropped after it
+	file.sequential( true );
+	const char *p = file.data() + sizeof( SnapshotHeader );
+	if ( checksum( p, file.size() - sizeof( SnapshotHeader ), 0 ) != h->checksum )
+		return false;
+	vector<Id> degs, adj, wts;
+	p = get_ints( p, h->n, h->degree_width, degs );
+	p = get_ints( p, 2 * h->m, h->neighbor_width, adj );
+	if ( h->weighted )
+		get_ints( p, h->n, h->weight_width, wts );
+	vector<Id> offs( h->n + 1, 0 );
+	for ( Id v = 0; v < h->n; ++v )
+		offs[v + 1] = offs[v] + degs[v];
+	if ( offs.back() != adj.size() )
+		return false;
+	for ( Id w : adj )
+		if ( w >= h->n )
+			return false;
+
+	offsets_data.swap( offs );
+	adjacency_data.swap( adj );
+	weights_data.swap( wts );
+	build( threads );
+	return true;
+}
+
+void Graph::dump( const string &outfile ) const{
+	SnapshotHeader h;
+	memset( &h, 0, sizeof( h ) );
+	copy( snapshot_magic, snapshot_magic + 8, h.magic );
+	h.version = snapshot_version;
+	h.n = num_vertices();
+	h.m = num_edges();
+	h.weighted = weighted();
+	if ( !file_stamp( source, h.source_size, h.source_mtime ) )
+		cout << "Could not stat " << source << ", the snapshot can't detect staleness\n";
+	strncpy( h.source, source.c_str(), sizeof( h.source ) - 1 );
+
+	vector<Id> degs( num_vertices() );
+	Id maxdeg = 0, maxweight = 0;
+	for ( Id v = 0; v < num_vertices(); ++v ){
+		degs[v] = degree( v );
+		maxdeg = max( maxdeg, degs[v] );
+		maxweight = max( maxweight, weight( v ) );
+	}
+	h.degree_width = int_width( maxdeg );
+	h.neighbor_width = int_width( num_vertices() > 0 ? num_vertices() - 1 : 0 );
+	h.weight_width = int_width( maxweight );
+	vector<char> payload;
+	put_ints( payload, degs.data(), degs.data() + degs.size(), h.degree_width );
+	put_ints( payload, adjacency.begin(), adjacency.end(), h.neighbor_width );
+	put_ints( payload, weights.begin(), weights.end(), h.weight_width );
+	payload.resize( ( payload.size() + 7 ) / 8 * 8, 0 );
+	h.checksum = checksum( payload.data(), payload.size(), 0 );
+
+	ofstream ofs( outfile, ios::binary );
+	ofs.write( reinterpret_cast<const char *>( &h ), sizeof( h ) );
+	ofs.write( payload.data(), payload.size() );
+	if ( !ofs.good() )
+		cout << "Could not write snapshot " << outfile << '\n';
+}
+
+vector<vector<Id>> Graph::components() const{
+	vector<vector<Id>> comps;
+	vector<bool> seen( num_vertices(), false );
+	for ( Id s = 0; s < num_vertices(); ++s ){
+		if ( seen[s] || degree( s ) == 0 )
+			continue;
+		// Breadth first, the component doubles as the queue
+		comps.emplace_back( 1, s );
+		vector<Id> &comp = comps.back();
+		seen[s] = true;
+		for ( size_t i = 0; i < comp.size(); ++i )
+			for ( Id w : neighs( comp[i] ) )
+				if ( !seen[w] ){
+					seen[w] = true;
+					comp.push_back( w );
+				}
+	}
+	stable_sort( comps.begin(), comps.end(), []( const vector<Id> &a, const vector<Id> &b ){
+		return a.size() < b.size();
+	} );
+	return comps;
+}
+
+Id Graph::weight( const vector<Id> &VC ) const{
+	if ( !weighted() )
+		return VC.size();
+	Id w = 0;
+	for ( Id v : VC )
+		w += weights[v];
+	return w;
+}
+
+void Graph::check_coverage( const vector<Id> &VC ) const{
 	cout << "cover size: " << VC.size() << '\n';
+	if ( weighted() )
+		cout << "cover weight: " << weight( VC ) << '\n';
 	int coveredcount = 0;
-	for ( auto &p : edges )
-		p.second = false;
+	vector<bool> covered( num_edges(), false );
 	for ( size_t i = 0; i < VC.size(); ++i ){
-		for ( Id j : vertices[VC[i]].neighs ){
-			auto e = edge( VC[i], j );
-			if ( !edges[e] ){
-				edges[e] = true;
+		for ( Id e : incident( VC[i] ) ){
+			if ( !covered[e] ){
+				covered[e] = true;
 				++coveredcount;
 			}
 		}
@@ -61,6 +466,23 @@ void Graph::check_coverage( vector<Id> &VC ){
 	cout << "covered: " << coveredcount << '\n';
 }
 
+bool Graph::adjacent( Id u, Id v ) const{
+	if ( degree( u ) > degree( v ) )
+		swap( u, v );
+	Neighbors n = neighs( u );
+	return binary_search( n.begin(), n.end(), v );
+}
+
+Id Graph::edge_id( Id u, Id v ) const{
+	if ( degree( u ) > degree( v ) )
+		swap( u, v );
+	Neighbors n = neighs( u );
+	const Id *it = lower_bound( n.begin(), n.end(), v );
+	if ( it == n.end() || *it != v )
+		return num_edges();
+	return edge_ids[offsets[u] + ( it - n.begin() )];
+}
+
 Edge edge( Id e1, Id e2 ){
 	return Edge( min( e1, e2 ), max( e1, e2 ) );
 }
\ No newline at end of file
@@ -1,45 +1,64 @@
 #include "heuristic.h"
+#include "incumbent.h"
+#include "containers.h"
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 
-vector<Id> greedybad( Graph &G ) {
+vector<Id> greedybad( const Graph &G, const vector<bool> &removed ) {
+	GreedyScratch scratch;
+	return greedybad( G, removed, scratch );
+}
+
+const vector<Id> &greedybad( const Graph &G, const vector<bool> &removed, GreedyScratch &scratch ) {
 	// Init
-	vector<Id> VC;
-	vector<Vertex> vertices = G.vertices;
+	vector<Id> &VC = scratch.VC;
+	VC.clear();
+	Id N = G.num_vertices();
 
-	unordered_set<Edge> uncovered;
-	for ( auto &p : G.edges )
-		uncovered.insert( p.first );
-	while ( !uncovered.empty() )
+	// Vertices that are removed or already in VC, and the residual degree of the rest
+	vector<bool> &gone = scratch.gone;
+	vector<Id> &deg = scratch.deg;
+	if ( !removed.empty() )
+		gone.assign( removed.begin(), removed.end() );
+	else
+		gone.assign( N, false );
+	deg.assign( N, 0 );
+	for ( Id i = 0; i < N; ++i )
+		if ( !gone[i] )
+			for ( Id j : G.neighs( i ) )
+				if ( !gone[j] )
+					++deg[i];
+	// Vertices by residual degree, O( V + E ) in all
+	BucketQueue<Id> &bydeg = scratch.bydeg;
+	bydeg.assign( deg );
+	while ( bydeg.top_key() > 0 )
 	{
-		// Find vertex vertices minimum degree
-		Id v = vertices.size();
-		for ( Id i = 0; i < vertices.size(); ++i )
-			if ( vertices[i].neighs.size() > 0
-				 && ( v == vertices.size() || vertices[v].neighs.size() > vertices[i].neighs.size() ) )
-				v = i;
-		if ( v == vertices.size() || vertices[v].neighs.empty() )
-			break;
+		// Find a vertex of minimum degree, the first one past the isolated ones
+		Id v = *bydeg.begin( 1 );
 
 		//Finding v's neighbour with minimum degree
-		Id minneigh = *min_element( vertices[v].neighs.begin(), vertices[v].neighs.end(),
-									[&]( Id a, Id b ){
-			return vertices[a].neighs.size() < vertices[b].neighs.size();
-		} );
+		Id minneigh = N;
+		for ( Id j : G.neighs( v ) )
+			if ( !gone[j] && ( minneigh == N || deg[minneigh] > deg[j] ) )
+				minneigh = j;
 
 		Id e[2] = { v, minneigh };
 		for ( Id i : e ){
 			VC.push_back( i );
-			for ( Id j : vertices[i].neighs )
-			{
-				// Remove edges from queues
-				uncovered.erase( edge( i, j ) );
-				vertices[j].neighs.erase( i );
-			}
-			vertices[i].neighs.clear();
+			gone[i] = true;
+			deg[i] = 0;
+			bydeg.set( i, 0 );
+			// Remove edges from residual graph
+			for ( Id j : G.neighs( i ) )
+				if ( !gone[j] ){
+					--deg[j];
+					bydeg.decrement( j );
+				}
 		}
 	}
 
@@ -48,109 +67,153 @@ vector<Id> greedybad( Graph &G ) {
 
 // The same one that is outlined in the slides of Lecture 19
 // TODO: Version where orphan edge only adds one vertex to VC.
-vector<Id> heuristic1( Graph &G ){
+vector<Id> heuristic1( const Graph &G ){
 	// Init
 	vector<Id> VC;
-	unordered_set<Edge> uncovered;
-	for ( auto &p : G.edges )
-		uncovered.insert( p.first );
-	while ( !uncovered.empty() ){
-		Edge e = *uncovered.begin();
+	vector<bool> covered( G.num_edges(), false );
+	for ( Id id = 0; id < G.num_edges(); ++id ){
+		if ( covered[id] )
+			continue;
+		Edge e = G.edges[id];
 
 		// Add to VC
-		uncovered.erase( uncovered.begin() );
 		VC.push_back( e.first );
 		VC.push_back( e.second );
 
 		// Remove neighbor edges
-		for ( Id j : G.vertices[e.first].neighs )
-			uncovered.erase( edge( e.first, j ) );
-		for ( Id j : G.vertices[e.second].neighs )
-			uncovered.erase( edge( e.second, j ) );
+		for ( Id f : G.incident( e.first ) )
+			covered[f] = true;
+		for ( Id f : G.incident( e.second ) )
+			covered[f] = true;
 	}
 	return VC;
 }
 
+// Uncovered edges of heuristic2/3 by edge id
+// Priority edges are kept on a stack, the rest are scanned in id order
+// state	- queue of each edge, stale stack entries are skipped on pop
+// next		- scan position of the non-priority queue
+class EdgeQueues{
+private:
+	enum : char { UNCOVERED, PRIORITY, COVERED };
+	vector<char> state;
+	vector<Id> priority;
+	Id next;
+
+public:
+	EdgeQueues( const Graph &G ) : state( G.num_edges(), UNCOVERED ), next( 0 ){
+		for ( Id id = 0; id < G.num_edges(); ++id ){
+			const Edge &e = G.edges[id];
+			if ( G.degree( e.first ) == 1 || G.degree( e.second ) == 1 )
+				prioritize( id );
+		}
+	}
+
+	bool empty(){
+		while ( !priority.empty() && state[priority.back()] != PRIORITY )
+			priority.pop_back();
+		while ( next < state.size() && state[next] != UNCOVERED )
+			++next;
+		return priority.empty() && next == state.size();
+	}
+
+	bool has_priority(){
+		return !empty() && !priority.empty();
+	}
+
+	// Only valid if not empty()
+	Id pop(){
+		Id id;
+		if ( !priority.empty() ){
+			id = priority.back();
+			priority.pop_back();
+		}
+		else
+			id = next++;
+		state[id] = COVERED;
+		return id;
+	}
+
+	void cover( Id id ){
+		state[id] = COVERED;
+	}
+
+	void prioritize( Id id ){
+		if ( state[id] != UNCOVERED )
+			return;
+		state[id] = PRIORITY;
+		priority.push_back( id );
+	}
+};
+
+// Id of the only edge of j whose other end is not gone yet
+static Id last_edge( const Graph &G, const vector<bool> &gone, Id j ){
+	Neighbors n = G.neighs( j ), inc = G.incident( j );
+	for ( size_t k = 0; k < n.size(); ++k )
+		if ( !gone[n[k]] )
+			return inc[k];
+	return G.num_edges();
+}
+
+// Neighbor of i that is not gone yet and has the most uncovered edges
+static Id max_neigh( const Graph &G, const vector<bool> &gone, const vector<Id> &deg, Id i ){
+	Id maxneigh = G.num_vertices();
+	for ( Id j : G.neighs( i ) )
+		if ( !gone[j] && ( maxneigh == G.num_vertices() || deg[j] > deg[maxneigh] ) )
+			maxneigh = j;
+	return maxneigh;
+}
+
 // An optimization of the original heuristic
 // It prioritizes the neighbor of edges that has a vertex with only one uncovered edge left
-vector<Id> heuristic2( Graph &G ){
+vector<Id> heuristic2( const Graph &G ){
 	// Init
 	vector<Id> VC;
-	unordered_set<Edge> uncovered;
-	unordered_set<Edge> priority_uncovered;
-	vector<Vertex> vertices = G.vertices;
-	for ( auto &p : G.edges ){
-		if ( G.vertices[p.first.first].neighs.size() == 1 || G.vertices[p.first.second].neighs.size() == 1 )
-			priority_uncovered.insert( p.first );
-		else
-			uncovered.insert( p.first );
-	}
-	while ( !uncovered.empty() || !priority_uncovered.empty() ){
-		Edge e;
-
+	EdgeQueues queues( G );
+	// Residual degrees, vertices whose edges are all covered are gone
+	vector<Id> deg( G.num_vertices() );
+	vector<bool> gone( G.num_vertices(), false );
+	for ( Id i = 0; i < G.num_vertices(); ++i )
+		deg[i] = G.degree( i );
+	while ( !queues.empty() ){
 		// Get next uncovered edge
-		if ( !priority_uncovered.empty() ){
-			e = *priority_uncovered.begin();
-			priority_uncovered.erase( priority_uncovered.begin() );
+		bool prio = queues.has_priority();
+		Edge e = G.edges[queues.pop()];
+		if ( prio ){
 			// Get the edges that touches our priority edge
 			// And select the one which has a vertex with max number of uncovered neighbor
-			if ( vertices[e.first].neighs.size() == 1 ){
-				int maxneigh = *vertices[e.second].neighs.begin();
-				for ( int j : vertices[e.second].neighs )
-					if ( vertices[j].neighs.size() > vertices[maxneigh].neighs.size() )
-						maxneigh = j;
-				e = edge( e.second, maxneigh );
-			}
-			else if ( vertices[e.second].neighs.size() == 1 ){
-				int maxneigh = *vertices[e.first].neighs.begin();
-				for ( int j : vertices[e.first].neighs )
-					if ( vertices[j].neighs.size() > vertices[maxneigh].neighs.size() )
-						maxneigh = j;
-				e = edge( e.first, maxneigh );
-			}
-		}
-		else{
-			e = *uncovered.begin();
-			uncovered.erase( uncovered.begin() );
+			if ( deg[e.first] == 1 )
+				e = edge( e.second, max_neigh( G, gone, deg, e.second ) );
+			else if ( deg[e.second] == 1 )
+				e = edge( e.first, max_neigh( G, gone, deg, e.first ) );
 		}
 
 		// Push to vertex cover list
 		// If edge is isolated, only one vertex is needed.
-		if ( vertices[e.first].neighs.size() > 1 )
+		if ( deg[e.first] > 1 )
 			VC.push_back( e.first );
-		if ( vertices[e.second].neighs.size() > 1 || vertices[e.first].neighs.size() == 1 )
+		if ( deg[e.second] > 1 || deg[e.first] == 1 )
 			VC.push_back( e.second );
 
 		// Cleanup
-		for ( Id j : G.vertices[e.first].neighs ){
-			Edge neigh = edge( e.first, j );
-			// Remove edges from queues
-			uncovered.erase( neigh );
-			priority_uncovered.erase( neigh );
-			// Remove edge from neighbor's edgelist
-			vertices[j].neighs.erase( e.first );
-			// If neighbor has one uncovered edge left, it becomes priority
-			if ( vertices[j].neighs.size() == 1 ){
-				Edge p_edge = edge( j, *vertices[j].neighs.begin() );
-				if ( uncovered.find( p_edge ) != uncovered.end() ){
-					priority_uncovered.insert( p_edge );
-					uncovered.erase( p_edge );
-				}
-			}
-		}
-		for ( Id j : G.vertices[e.second].neighs ){
-			Edge neigh = edge( e.second, j );
-			// Remove edges from queues
-			uncovered.erase( neigh );
-			priority_uncovered.erase( neigh );
-			// Remove edge from neighbor's edgelist
-			vertices[j].neighs.erase( e.second );
-			// If neighbor has one uncovered edge left, it becomes priority
-			if ( vertices[j].neighs.size() == 1 ){
-				Edge p_edge = edge( j, *vertices[j].neighs.begin() );
-				if ( uncovered.find( p_edge ) != uncovered.end() ){
-					priority_uncovered.insert( p_edge );
-					uncovered.erase( p_edge );
+		gone[e.first] = gone[e.second] = true;
+		Id ends[2] = { e.first, e.second };
+		for ( Id i : ends ){
+			Neighbors n = G.neighs( i ), inc = G.incident( i );
+			for ( size_t k = 0; k < n.size(); ++k ){
+				Id j = n[k];
+				// Remove edges from queues
+				queues.cover( inc[k] );
+				if ( gone[j] )
+					continue;
+				// Remove edge from neighbor's edgelist
+				--deg[j];
+				// If neighbor has one uncovered edge left, it becomes priority
+				// (It may have none once the other end is processed too)
+				if ( deg[j] == 1 ){
+					Id f = last_edge( G, gone, j );
+					if ( f != G.num_edges() )
+						queues.prioritize( f );
 				}
 			}
 		}
@@ -160,99 +223,308 @@ vector<Id> heuristic2( Graph &G ){
 
 // An optimization of the original heuristic
 // It prioritizes edges that has a vertex with only one uncovered edge left, but only adds the other vertex
-vector<Id> heuristic3( Graph &G ){
+vector<Id> heuristic3( const Graph &G ){
 	// Init
 	vector<Id> VC;
-	unordered_set<Edge> uncovered;
-	unordered_set<Edge> priority_uncovered;
-	vector<Vertex> vertices = G.vertices;
-	for ( auto &p : G.edges ){
-		if ( G.vertices[p.first.first].neighs.size() == 1 || G.vertices[p.first.second].neighs.size() == 1 )
-			priority_uncovered.insert( p.first );
-		else
-			uncovered.insert( p.first );
-	}
-	while ( !uncovered.empty() || !priority_uncovered.empty() ){
-		Edge e;
-
+	EdgeQueues queues( G );
+	// Residual degrees, vertices whose edges are all covered are gone
+	vector<Id> deg( G.num_vertices() );
+	vector<bool> gone( G.num_vertices(), false );
+	for ( Id i = 0; i < G.num_vertices(); ++i )
+		deg[i] = G.degree( i );
+	while ( !queues.empty() ){
 		// Get next uncovered edge
-		if ( !priority_uncovered.empty() ){
-			e = *priority_uncovered.begin();
-			priority_uncovered.erase( priority_uncovered.begin() );
-		}
-		else{
-			e = *uncovered.begin();
-			uncovered.erase( uncovered.begin() );
-		}
+		Edge e = G.edges[queues.pop()];
 
 		// Push to vertex cover list
 		// If edge is isolated, only one vertex is needed.
-		if ( vertices[e.first].neighs.size() > 1 )
+		if ( deg[e.first] > 1 )
 			VC.push_back( e.first );
-		if ( vertices[e.second].neighs.size() > 1 || vertices[e.first].neighs.size() == 1 )
+		if ( deg[e.second] > 1 || deg[e.first] == 1 )
 			VC.push_back( e.second );
 
 		// Cleanup
-		for ( Id j : G.vertices[e.first].neighs ){
-			Edge neigh = edge( e.first, j );
-			// Remove edges from queues
-			uncovered.erase( neigh );
-			priority_uncovered.erase( neigh );
-			// Remove edge from neighbor's edgelist
-			vertices[j].neighs.erase( e.first );
-			// If neighbor has one uncovered edge left, it becomes priority
-			if ( vertices[j].neighs.size() == 1 ){
-				Edge p_edge = edge( j, *vertices[j].neighs.begin() );
-				if ( uncovered.find( p_edge ) != uncovered.end() ){
-					priority_uncovered.insert( p_edge );
-					uncovered.erase( p_edge );
+		gone[e.first] = gone[e.second] = true;
+		Id ends[2] = { e.first, e.second };
+		for ( Id i : ends ){
+			Neighbors n = G.neighs( i ), inc = G.incident( i );
+			for ( size_t k = 0; k < n.size(); ++k ){
+				Id j = n[k];
+				// Remove edges from queues
+				queues.cover( inc[k] );
+				if ( gone[j] )
+					continue;
+				// Remove edge from neighbor's edgelist
+				--deg[j];
+				// If neighbor has one uncovered edge left, it becomes priority
+				// (It may have none once the other end is processed too)
+				if ( deg[j] == 1 ){
+					Id f = last_edge( G, gone, j );
+					if ( f != G.num_edges() )
+						queues.prioritize( f );
 				}
 			}
 		}
-		for ( Id j : G.vertices[e.second].neighs ){
-			Edge neigh = edge( e.second, j );
-			// Remove edges from queues
-			uncovered.erase( neigh );
-			priority_uncovered.erase( neigh );
-			// Remove edge from neighbor's edgelist
-			vertices[j].neighs.erase( e.second );
-			// If neighbor has one uncovered edge left, it becomes priority
-			if ( vertices[j].neighs.size() == 1 ){
-				Edge p_edge = edge( j, *vertices[j].neighs.begin() );
-				if ( uncovered.find( p_edge ) != uncovered.end() ){
-					priority_uncovered.insert( p_edge );
-					uncovered.erase( p_edge );
+	}
+	return VC;
+}
+
+// Reproducible pseudo random priority of an id, splitmix64
+static uint64_t priority( uint64_t x ){
+	x += 0x9e3779b97f4a7c15ULL;
+	x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+	x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebULL;
+	return x ^ ( x >> 31 );
+}
+
+// Concatenation of per thread lists, in thread order
+static vector<Id> concat( vector<vector<Id>> &parts ){
+	size_t n = 0;
+	for ( const vector<Id> &p : parts )
+		n += p.size();
+	vector<Id> all;
+	all.reserve( n );
+	for ( vector<Id> &p : parts ){
+		all.insert( all.end(), p.begin(), p.end() );
+		vector<Id>().swap( p );
+	}
+	return all;
+}
+
+// Drops cover vertices whose neighbors are all in the cover, then lists the cover
+// Candidates are found in parallel and confirmed in order, as two adjacent ones can not both go
+static vector<Id> prune_and_list( const Graph &G, vector<char> &in, unsigned threads ){
+	vector<vector<Id>> parts( threads );
+	parallel_for( threads, G.num_vertices(), [&]( unsigned t, size_t b, size_t e ){
+		for ( Id v = b; v < e; ++v ){
+			if ( !in[v] )
+				continue;
+			bool redundant = true;
+			for ( Id w : G.neighs( v ) )
+				if ( !in[w] ){
+					redundant = false;
+					break;
 				}
+			if ( redundant )
+				parts[t].push_back( v );
+		}
+	} );
+	for ( Id v : concat( parts ) ){
+		bool redundant = true;
+		for ( Id w : G.neighs( v ) )
+			redundant &= in[w] != 0;
+		if ( redundant )
+			in[v] = 0;
+	}
+	parallel_for( threads, G.num_vertices(), [&]( unsigned t, size_t b, size_t e ){
+		for ( Id v = b; v < e; ++v )
+			if ( in[v] )
+				parts[t].push_back( v );
+	} );
+	return concat( parts );
+}
+
+vector<Id> parallel_matching( const Graph &G, unsigned threads ){
+	threads = max( 1u, threads );
+	Id N = G.num_vertices(), M = G.num_edges();
+	vector<char> in( N, 0 );
+	// Uncovered edge of least priority of each vertex, M if none
+	vector<Id> ptr( N, M );
+	vector<vector<Id>> parts( threads );
+	parallel_for( threads, N, [&]( unsigned t, size_t b, size_t e ){
+		for ( Id v = b; v < e; ++v )
+			if ( G.degree( v ) > 0 )
+				parts[t].push_back( v );
+	} );
+	vector<Id> live = concat( parts );
+	while ( !live.empty() ){
+		parallel_for( threads, live.size(), [&]( unsigned, size_t b, size_t e ){
+			for ( size_t i = b; i < e; ++i ){
+				Id v = live[i], best = M;
+				Neighbors n = G.neighs( v ), inc = G.incident( v );
+				for ( size_t k = 0; k < n.size(); ++k )
+					if ( !in[n[k]] && ( best == M || priority( inc[k] ) < priority( best ) ) )
+						best = inc[k];
+				ptr[v] = best;
+			}
+		} );
+		// Edges both ends point at are matched, the least one left always is
+		parallel_for( threads, live.size(), [&]( unsigned, size_t b, size_t e ){
+			for ( size_t i = b; i < e; ++i ){
+				Id v = live[i];
+				if ( ptr[v] == M )
+					continue;
+				const Edge &f = G.edges[ptr[v]];
+				Id u = f.first == v ? f.second : f.first;
+				if ( v < u && ptr[u] == ptr[v] )
+					in[v] = in[u] = 1;
 			}
+		} );
+		parallel_for( threads, live.size(), [&]( unsigned t, size_t b, size_t e ){
+			for ( size_t i = b; i < e; ++i )
+				if ( !in[live[i]] && ptr[live[i]] != M )
+					parts[t].push_back( live[i] );
+		} );
+		live = concat( parts );
+	}
+	return prune_and_list( G, in, threads );
+}
+
+// Degree level of the greedy, degrees within a factor 1.25 share one
+static int level( Id d ){
+	return static_cast<int>( log( static_cast<double>( d ) ) / log( 1.25 ) );
+}
+
+vector<Id> parallel_greedy( const Graph &G, unsigned threads ){
+	threads = max( 1u, threads );
+	Id N = G.num_vertices();
+	vector<char> in( N, 0 );
+	vector<atomic<Id>> deg( N );
+	// Round in which a vertex was last a candidate
+	vector<unsigned> round( N, 0 );
+	unsigned r = 0;
+	// Every vertex with uncovered edges sits in the bucket of its level or above, it moves down when that bucket comes up
+	vector<vector<Id>> bucket;
+	for ( Id v = 0; v < N; ++v ){
+		deg[v].store( G.degree( v ), memory_order_relaxed );
+		if ( G.degree( v ) == 0 )
+			continue;
+		size_t l = level( G.degree( v ) );
+		if ( l >= bucket.size() )
+			bucket.resize( l + 1 );
+		bucket[l].push_back( v );
+	}
+	vector<vector<Id>> parts( threads ), fell( threads );
+	for ( size_t l = bucket.size(); l-- > 0; ){
+		while ( !bucket[l].empty() ){
+			vector<Id> &B = bucket[l];
+			++r;
+			parallel_for( threads, B.size(), [&]( unsigned t, size_t b, size_t e ){
+				for ( size_t i = b; i < e; ++i ){
+					Id v = B[i], d = deg[v].load( memory_order_relaxed );
+					if ( in[v] || d == 0 )
+						continue;
+					if ( static_cast<size_t>( level( d ) ) < l )
+						fell[t].push_back( v );
+					else{
+						round[v] = r;
+						parts[t].push_back( v );
+					}
+				}
+			} );
+			for ( Id v : concat( fell ) )
+				bucket[level( deg[v].load( memory_order_relaxed ) )].push_back( v );
+			vector<Id> cand = concat( parts );
+
+			// Candidates that beat all candidate neighbors on ( degree, priority ) go in, they are independent
+			parallel_for( threads, cand.size(), [&]( unsigned t, size_t b, size_t e ){
+				for ( size_t i = b; i < e; ++i ){
+					Id c = cand[i], dc = deg[c].load( memory_order_relaxed );
+					bool top = true;
+					for ( Id w : G.neighs( c ) ){
+						if ( in[w] || round[w] != r )
+							continue;
+						Id dw = deg[w].load( memory_order_relaxed );
+						if ( dw > dc || ( dw == dc && priority( w ) > priority( c ) ) || ( dw == dc && priority( w ) == priority( c ) && w > c ) ){
+							top = false;
+							break;
+						}
+					}
+					if ( top )
+						parts[t].push_back( c );
+				}
+			} );
+			vector<Id> joined = concat( parts );
+			parallel_for( threads, joined.size(), [&]( unsigned, size_t b, size_t e ){
+				for ( size_t i = b; i < e; ++i ){
+					Id j = joined[i];
+					in[j] = 1;
+					deg[j].store( 0, memory_order_relaxed );
+					for ( Id w : G.neighs( j ) )
+						if ( !in[w] )
+							deg[w].fetch_sub( 1, memory_order_relaxed );
+				}
+			} );
+
+			// The rest of the candidates try again
+			parallel_for( threads, cand.size(), [&]( unsigned t, size_t b, size_t e ){
+				for ( size_t i = b; i < e; ++i )
+					if ( !in[cand[i]] )
+						parts[t].push_back( cand[i] );
+			} );
+			B = concat( parts );
 		}
 	}
+	return prune_and_list( G, in, threads );
+}
+
+vector<Id> primal_dual( const Graph &G ){
+	// Each edge raises its dual until one endpoint is paid for, paid vertices form the cover
+	vector<Id> left( G.num_vertices() );
+	vector<char> in( G.num_vertices(), 0 );
+	for ( Id v = 0; v < G.num_vertices(); ++v )
+		left[v] = G.weight( v );
+	for ( const Edge &e : G.edges ){
+		if ( in[e.first] || in[e.second] )
+			continue;
+		Id pay = min( left[e.first], left[e.second] );
+		left[e.first] -= pay;
+		left[e.second] -= pay;
+		in[e.first] = left[e.first] == 0;
+		in[e.second] = left[e.second] == 0;
+	}
+
+	// Heaviest first, drop vertices whose neighbors are all in the cover
+	vector<Id> VC;
+	for ( Id v = 0; v < G.num_vertices(); ++v )
+		if ( in[v] )
+			VC.push_back( v );
+	stable_sort( VC.begin(), VC.end(), [&]( Id a, Id b ){
+		return G.weight( a ) > G.weight( b );
+	} );
+	size_t kept = 0;
+	for ( Id v : VC ){
+		bool redundant = true;
+		for ( Id w : G.neighs( v ) )
+			redundant &= in[w] != 0;
+		if ( redundant )
+			in[v] = 0;
+		else
+			VC[kept++] = v;
+	}
+	VC.resize( kept );
 	return VC;
 }
 
-void heuristic( Graph &G ){
+vector<Id> heuristic( const Graph &G, unsigned threads, const Kernel *kernel ){
 	ostringstream oss;
 	oss << "output/" << G.filename.substr( 0, G.filename.size() - 6u ) << "_Approx";
-
-	chrono::time_point<std::chrono::system_clock> start, end;
-	start = chrono::system_clock::now();
-	vector<Id> VC = heuristic3( G );
-	end = chrono::system_clock::now();
-	chrono::duration<double> elapsed_seconds = end - start;
-	ofstream ofs( oss.str() + ".trace" );
-	ofs << elapsed_seconds.count() << ',' << VC.size();
-	ofs.close();
-
-	ofs.open( oss.str() + ".sol" );
-	ofs << VC.size() << '\n';
-	for ( size_t i = 0; i < VC.size(); ++i ){
-		if ( i != 0 )
-			ofs << ',';
-		ofs << ( VC[i] + 1 );
+	Incumbent incumbent( oss.str(), Clock::now(), kernel );
+	if ( G.weighted() ){
+		vector<Id> VC = primal_dual( G );
+		incumbent.offer( G.weight( VC ), 0 );
+		cout << "Approx: primal-dual " << G.weight( VC ) << '\n';
+		return incumbent.write_solution( VC );
 	}
-	G.check_coverage( VC );
+
+	// The parallel ones first, they are the fast answers, then heuristic3, the smallest cover is kept
+	vector<Id> VC = parallel_matching( G, threads );
+	incumbent.offer( VC.size(), 0 );
+	cout << "Approx: matching " << VC.size();
+	vector<Id> temp = parallel_greedy( G, threads );
+	cout << ", greedy " << temp.size();
+	if ( incumbent.offer( temp.size(), 0 ) )
+		VC = move( temp );
+	temp = heuristic3( G );
+	cout << ", heuristic3 " << temp.size() << '\n';
+	if ( incumbent.offer( temp.size(), 0 ) )
+		VC = move( temp );
+	return incumbent.write_solution( VC );
 }
 
-vector<Id> getBestHeuristic( Graph &G ){
+vector<Id> getBestHeuristic( const Graph &G ){
+	if ( G.weighted() )
+		return primal_dual( G );
 	vector<Id> VC = heuristic1( G );
 	{
 		vector<Id> temp = heuristic2( G );
@@ -0,0 +1,34 @@
+#include "incumbent.h"
+
+Incumbent::Incumbent( const string &outfile_, TimePoint start_, const Kernel *kernel_ )
+	: best( static_cast<size_t>( -1 ) ), owner( 0 ), start( start_ ), ofs( outfile_ + ".trace" ), outfile( outfile_ ), kernel( kernel_ ){
+	if ( kernel )
+		start -= chrono::duration_cast<Clock::duration>( SecondsDouble( kernel->seconds ) );
+}
+
+bool Incumbent::offer( size_t size, unsigned thread, double rate ){
+	if ( size >= best.load( memory_order_relaxed ) )
+		return false;
+	lock_guard<mutex> guard( lock );
+	if ( size >= best.load( memory_order_relaxed ) )
+		return false;
+	best.store( size, memory_order_relaxed );
+	owner = thread;
+	ofs << seconds_since( start ) << ',' << ( kernel ? size + kernel->offset() : size );
+	if ( rate >= 0.0 )
+		ofs << ',' << rate;
+	ofs << '\n';
+	return true;
+}
+
+vector<Id> Incumbent::write_solution( const vector<Id> &kernelVC ) const{
+	vector<Id> VC = kernel ? kernel->lift( kernelVC ) : kernelVC;
+	ofstream solfs( outfile + ".sol" );
+	solfs << VC.size() << '\n';
+	for ( size_t i = 0; i < VC.size(); ++i ){
+		if ( i != 0 )
+			solfs << ',';
+		solfs << ( VC[i] + 1 );
+	}
+	return VC;
+}
\ No newline at end of file
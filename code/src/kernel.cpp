@@ -0,0 +1,368 @@
+#include "kernel.h"
+#include "timer.h"
+#include <algorithm>
+
+vector<Id> Kernel::lift( const vector<Id> &VC ) const{
+	vector<Id> res( forced );
+	for ( Id v : VC )
+		res.push_back( original[v] );
+	if ( folds.empty() )
+		return res;
+	vector<bool> in( input_size, false );
+	for ( Id v : res )
+		in[v] = true;
+	for ( size_t i = folds.size(); i-- > 0; ){
+		Id x = in[folds[i].u] ? folds[i].w : folds[i].v;
+		in[x] = true;
+		res.push_back( x );
+	}
+	return res;
+}
+
+void Kernel::compose( unique_ptr<Kernel> next ){
+	for ( Id v : next->forced )
+		forced.push_back( original[v] );
+	heavy += next->heavy;
+	for ( const Fold &f : next->folds ){
+		Fold g = { original[f.v], original[f.u], original[f.w] };
+		folds.push_back( g );
+	}
+	for ( Id &v : next->original )
+		v = original[v];
+	original.swap( next->original );
+	graph = move( next->graph );
+	seconds += next->seconds;
+}
+
+// Hopcroft-Karp on the bipartite double cover of G, left copy of u is adjacent to the right copies of N( u )
+// Iterative, so long augmenting paths do not overflow the stack
+// left, right	- mate of each left/right copy, num_vertices() if unmatched
+static void double_cover_matching( const Graph &G, vector<Id> &left, vector<Id> &right ){
+	Id N = G.num_vertices();
+	const Id INF = static_cast<Id>( -1 );
+	left.assign( N, N );
+	right.assign( N, N );
+	vector<Id> dist( N ), queue, it( N ), stack;
+	queue.reserve( N );
+	while ( true ){
+		// BFS layers from the free left vertices
+		queue.clear();
+		for ( Id u = 0; u < N; ++u ){
+			dist[u] = left[u] == N ? 0 : INF;
+			if ( left[u] == N )
+				queue.push_back( u );
+		}
+		bool found = false;
+		for ( size_t h = 0; h < queue.size(); ++h ){
+			Id u = queue[h];
+			for ( Id v : G.neighs( u ) ){
+				Id w = right[v];
+				if ( w == N )
+					found = true;
+				else if ( dist[w] == INF ){
+					dist[w] = dist[u] + 1;
+					queue.push_back( w );
+				}
+			}
+		}
+		if ( !found )
+			break;
+
+		// Vertex disjoint shortest augmenting paths along the layers
+		for ( Id u = 0; u < N; ++u )
+			it[u] = G.offsets[u];
+		for ( Id s = 0; s < N; ++s ){
+			if ( left[s] != N )
+				continue;
+			stack.assign( 1, s );
+			while ( !stack.empty() ){
+				Id u = stack.back();
+				if ( it[u] == G.offsets[u + 1] ){
+					// Dead end
+					dist[u] = INF;
+					stack.pop_back();
+					continue;
+				}
+				Id v = G.adjacency[it[u]++];
+				Id w = right[v];
+				if ( w == N ){
+					// Augment along the stack, each left vertex takes the right vertex it came through
+					for ( size_t k = stack.size(); k-- > 0; ){
+						Id x = stack[k], y = k + 1 == stack.size() ? v : G.adjacency[it[x] - 1];
+						left[x] = y;
+						right[y] = x;
+					}
+					break;
+				}
+				if ( dist[w] == dist[u] + 1 )
+					stack.push_back( w );
+			}
+		}
+	}
+}
+
+vector<char> half_integral_lp( const Graph &G ){
+	Id N = G.num_vertices();
+	vector<Id> left, right;
+	double_cover_matching( G, left, right );
+
+	// Koenig: Z is what alternating paths reach from the free left vertices,
+	// the minimum cover is the left copies outside Z and the right copies in Z
+	vector<bool> zleft( N, false ), zright( N, false );
+	vector<Id> queue;
+	for ( Id u = 0; u < N; ++u )
+		if ( left[u] == N ){
+			zleft[u] = true;
+			queue.push_back( u );
+		}
+	for ( size_t h = 0; h < queue.size(); ++h )
+		for ( Id v : G.neighs( queue[h] ) ){
+			if ( zright[v] )
+				continue;
+			zright[v] = true;
+			Id w = right[v];
+			if ( w != N && !zleft[w] ){
+				zleft[w] = true;
+				queue.push_back( w );
+			}
+		}
+
+	vector<char> x( N );
+	for ( Id u = 0; u < N; ++u )
+		x[u] = !zleft[u] + zright[u];
+	return x;
+}
+
+unique_ptr<Kernel> nemhauser_trotter( const Graph &G ){
+	TimePoint start = Clock::now();
+	unique_ptr<Kernel> K( new Kernel );
+	K->input_size = G.num_vertices();
+	vector<char> x = half_integral_lp( G );
+	for ( Id u = 0; u < G.num_vertices(); ++u ){
+		if ( x[u] == 2 )
+			K->forced.push_back( u );
+		else if ( x[u] == 1 )
+			K->original.push_back( u );
+	}
+	K->graph.reset( new Graph( G, K->original ) );
+	K->seconds = seconds_since( start );
+	return K;
+}
+
+// Rule based reductions on a mutable copy of the graph, each list is unsorted
+// Folds keep the id of u for the merged vertex
+// adj		- neighbors of each vertex still in the graph
+// alive	- false once a vertex is taken, dropped or merged away
+// queue	- vertices whose neighborhood changed, queued says which are in it
+// mark		- stamp array for neighborhood tests
+class Reducer{
+private:
+	vector<vector<Id>> adj;
+	vector<bool> alive, queued;
+	vector<Id> queue;
+	vector<unsigned> mark;
+	unsigned stamp;
+	Kernel &K;
+
+	void push( Id v ){
+		if ( !queued[v] ){
+			queued[v] = true;
+			queue.push_back( v );
+		}
+	}
+
+	static void erase( vector<Id> &list, Id v ){
+		auto it = find( list.begin(), list.end(), v );
+		*it = list.back();
+		list.pop_back();
+	}
+
+	// Stamp N( u ), plus u itself if closed
+	void mark_neighs( Id u, bool closed ){
+		if ( ++stamp == 0 ){
+			fill( mark.begin(), mark.end(), 0 );
+			stamp = 1;
+		}
+		for ( Id x : adj[u] )
+			mark[x] = stamp;
+		if ( closed )
+			mark[u] = stamp;
+	}
+
+	void remove( Id v ){
+		alive[v] = false;
+		for ( Id x : adj[v] ){
+			erase( adj[x], v );
+			push( x );
+		}
+		vector<Id>().swap( adj[v] );
+	}
+
+	void take( Id v ){
+		K.forced.push_back( v );
+		remove( v );
+	}
+
+	// v has exactly the non-adjacent neighbors u and w
+	void fold( Id v, Id u, Id w ){
+		Fold f = { v, u, w };
+		K.folds.push_back( f );
+		remove( v );
+		mark_neighs( u, true );
+		for ( Id x : adj[w] ){
+			erase( adj[x], w );
+			if ( mark[x] != stamp ){
+				adj[x].push_back( u );
+				adj[u].push_back( x );
+			}
+			push( x );
+		}
+		alive[w] = false;
+		vector<Id>().swap( adj[w] );
+		push( u );
+	}
+
+	// A neighbor u with N[v] in N[u], some minimum cover contains u
+	Id dominator( Id v ){
+		for ( Id u : adj[v] ){
+			if ( adj[u].size() < adj[v].size() )
+				continue;
+			mark_neighs( u, true );
+			bool dominates = true;
+			for ( Id x : adj[v] )
+				if ( mark[x] != stamp ){
+					dominates = false;
+					break;
+				}
+			if ( dominates )
+				return u;
+		}
+		return v;
+	}
+
+	// Degree-3 vertex t, not adjacent to v, with N( t ) = N( v ), v otherwise
+	Id twin( Id v ){
+		mark_neighs( v, false );
+		for ( Id t : adj[adj[v][0]] ){
+			if ( t == v || adj[t].size() != 3 || mark[t] == stamp )
+				continue;
+			if ( mark[adj[t][0]] == stamp && mark[adj[t][1]] == stamp && mark[adj[t][2]] == stamp )
+				return t;
+		}
+		return v;
+	}
+
+	void reduce( Id v ){
+		if ( !alive[v] )
+			return;
+		size_t d = adj[v].size();
+		if ( d == 0 ){
+			alive[v] = false;
+			return;
+		}
+		if ( d == 1 ){
+			take( adj[v][0] );
+			return;
+		}
+		if ( d == 2 ){
+			Id u = adj[v][0], w = adj[v][1];
+			mark_neighs( u, false );
+			if ( mark[w] == stamp ){
+				// Triangle, u and w cover it
+				take( u );
+				take( w );
+			}
+			else
+				fold( v, u, w );
+			return;
+		}
+		Id u = dominator( v );
+		if ( u != v ){
+			take( u );
+			push( v );
+			return;
+		}
+		if ( d == 3 ){
+			Id t = twin( v );
+			if ( t != v ){
+				// If the common neighbors have an edge among them, some minimum cover contains all three
+				Id a = adj[v][0], b = adj[v][1], c = adj[v][2];
+				mark_neighs( a, false );
+				bool edge = mark[b] == stamp || mark[c] == stamp;
+				if ( !edge ){
+					mark_neighs( b, false );
+					edge = mark[c] == stamp;
+				}
+				if ( edge ){
+					take( a );
+					take( b );
+					take( c );
+				}
+			}
+		}
+	}
+
+public:
+	Reducer( const Graph &G, Kernel &K_ )
+		: adj( G.num_vertices() ), alive( G.num_vertices(), true ), queued( G.num_vertices(), true ),
+		mark( G.num_vertices(), 0 ), stamp( 0 ), K( K_ ){
+		for ( Id v = 0; v < G.num_vertices(); ++v )
+			adj[v].assign( G.neighs( v ).begin(), G.neighs( v ).end() );
+		// Low ids get popped first
+		for ( Id v = G.num_vertices(); v-- > 0; )
+			queue.push_back( v );
+	}
+
+	void run(){
+		while ( !queue.empty() ){
+			Id v = queue.back();
+			queue.pop_back();
+			queued[v] = false;
+			reduce( v );
+		}
+	}
+
+	// The graph left, renumbered
+	void finish( const Graph &G ){
+		vector<Id> newid( adj.size(), adj.size() );
+		for ( Id v = 0; v < adj.size(); ++v )
+			if ( alive[v] ){
+				newid[v] = K.original.size();
+				K.original.push_back( v );
+			}
+		vector<vector<Id>> lists( K.original.size() );
+		for ( Id i = 0; i < lists.size(); ++i ){
+			for ( Id x : adj[K.original[i]] )
+				lists[i].push_back( newid[x] );
+			vector<Id>().swap( adj[K.original[i]] );
+		}
+		K.graph.reset( new Graph( lists, G.filename ) );
+	}
+};
+
+unique_ptr<Kernel> reduce( const Graph &G ){
+	TimePoint start = Clock::now();
+	unique_ptr<Kernel> K( new Kernel );
+	K->input_size = G.num_vertices();
+	{
+		Reducer reducer( G, *K );
+		reducer.run();
+		reducer.finish( G );
+	}
+	K->seconds = 0.0;
+	while ( K->graph->num_vertices() > 0 ){
+		unique_ptr<Kernel> nt = nemhauser_trotter( *K->graph );
+		if ( nt->graph->num_vertices() == K->graph->num_vertices() )
+			break;
+		K->compose( move( nt ) );
+		unique_ptr<Kernel> next( new Kernel );
+		next->input_size = K->graph->num_vertices();
+		Reducer reducer( *K->graph, *next );
+		reducer.run();
+		reducer.finish( *K->graph );
+		next->seconds = 0.0;
+		K->compose( move( next ) );
+	}
+	K->seconds = seconds_since( start );
+	return K;
+}
\ No newline at end of file
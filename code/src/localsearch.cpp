@@ -1,77 +1,193 @@
 #include "localsearch.h"
 #include "heuristic.h"
+#include "containers.h"
+#include "incumbent.h"
+#include "stats.h"
+#include "timer.h"
+#include "bitgraph.h"
 #include <algorithm>
 #include <numeric>
 #include <unordered_set>
 #include <iomanip>
 #include <random>
-#include <chrono>
 
 using namespace std;
 
-using TimePoint = chrono::time_point<std::chrono::system_clock>;
-using SecondsDouble = chrono::duration<double>;
 
 // G					- The graph
-// VC					- Current solution
-// MinVC				- best solution
-// nodeW				- Weight for nodes
-// edgeW				- Weight for edges
+// cover				- Current solution, ordered by nodeW (score if weighted) so the cheapest vertex to remove is on top
+// coverW				- weight of the current solution, its size if the graph is unweighted
+// MinVC				- best solution, stale while logging is set
+// bestW				- weight of the best solution
+// sinceBest			- VC changes ( vertex, added ) made since the best solution, if logging
+// nodeW				- Total weight of the uncovered edges of each node, kept up to date on every move
+//						  For a vertex in VC it is the loss of removing it, for one outside the gain of adding it
+// score				- nodeW per unit of vertex weight, only kept for weighted graphs and cover vertices
+// edgeW				- Weight for edges, by edge id. Only valid if edgeEpoch matches epoch, 0.05 otherwise
+// epoch				- bumped to reset all edge weights at once
+// outside				- Number of neighbors of each node that are not in VC
 // taboo_swap			- Taboo edge
 // gen					- random generator
+// stats				- exchanges tried, exchanges made, edge weight bumps and weight resets after a cover was taken apart
 // cutoff				- cutoff time in seconds
-// start				- starting time point of solver
-// ofs					- ofstream to write to trace
+// start				- starting time point of the run
+// incumbent			- shared best cover of all threads
+// thread				- index of this solver in the run
+// stop					- the search returns as soon as it is set, if given
 class StochasticSolver{
 private:
-	Graph &G;
-	unordered_set<Id> VC, MinVC;
-	vector<double> nodeW;
-	unordered_map<Edge, double> edgeW;
+	const Graph &G;
+	IndexedMinHeap<Id, double> cover;
+	Id coverW;
+	vector<bool> MinVC;
+	Id bestW;
+	vector<pair<Id, bool>> sinceBest;
+	bool logging;
+	vector<double> nodeW, score;
+	vector<double> edgeW;
+	vector<unsigned> edgeEpoch;
+	unsigned epoch;
+	vector<Id> outside;
 	Edge taboo_swap;
 
 	mt19937 gen;
+	enum { STEPS, SWAPS, BUMPS, RESTARTS };
+	Counters stats;
 
 	double cutoff;
 	TimePoint start;
-	ofstream ofs;
-	string outfile;
+	Incumbent &incumbent;
+	unsigned thread;
+	const atomic<bool> *stop;
 
 public:
-	StochasticSolver( Graph &G_, double cutoff_, int seed ) : G( G_ ), gen( seed ), cutoff( cutoff_ ){
-		ostringstream oss;
-		oss << "output/" << G.filename.substr( 0, G.filename.size() - 6u ) << "_LS1_" << cutoff << '_' << seed;
-		outfile = oss.str();
+	StochasticSolver( const Graph &G_, double cutoff_, int seed, TimePoint start_, Incumbent &incumbent_, unsigned thread_,
+		const atomic<bool> *stop_ = nullptr )
+		: G( G_ ), logging( false ), epoch( 0 ), gen( seed ), stats( "LS1 " + to_string( thread_ ), { "steps", "swaps", "bumps", "restarts" } ), cutoff( cutoff_ ), start( start_ ),
+		incumbent( incumbent_ ), thread( thread_ ), stop( stop_ ) {}
+
+	double weight( Id e ) const {
+		return edgeEpoch[e] == epoch ? edgeW[e] : 0.05;
 	}
 
-	pair<Id, Id> vertexPairToExchange( const Edge &e ){
-		vector<Id> elist = { e.first, e.second };
-		// Adjust weight for vertices in VC and e. More edge -> more weight
-		for ( Id u : VC ){
-			nodeW[u] = 0.0;
-			for ( Id v : G.vertices[u].neighs )
-				if ( VC.find( v ) == VC.end() )
-					nodeW[u] += edgeW[edge( u, v )];
+	void bumpWeight( Id e ){
+		if ( edgeEpoch[e] != epoch ){
+			edgeEpoch[e] = epoch;
+			edgeW[e] = 0.05;
+		}
+		++edgeW[e];
+	}
+
+	// Weight of u to divide gains by, weight 0 counts as 1
+	double price( Id u ) const { return max( G.weight( u ), Id( 1 ) ); }
+
+	void rescore( Id u ){
+		if ( G.weighted() )
+			score[u] = nodeW[u] / price( u );
+	}
+
+	// Reset every edge weight to 0.05 in O(|V|)
+	void resetWeights(){
+		++epoch;
+		for ( Id u = 0; u < G.num_vertices(); ++u ){
+			nodeW[u] = 0.05 * outside[u];
+			rescore( u );
 		}
-		for ( Id u : elist ){
-			nodeW[u] = 0.0;
-			for ( Id v : G.vertices[u].neighs )
-				if ( VC.find( v ) == VC.end() )
-					nodeW[u] += edgeW[edge( u, v )];
+		cover.rebuild();
+	}
+
+	// The current cover is the best one, copy it lazily
+	void recordBest(){
+		bestW = coverW;
+		sinceBest.clear();
+		logging = true;
+	}
+
+	// Copy the best cover by undoing the moves made since
+	void materializeBest(){
+		if ( !logging )
+			return;
+		for ( Id u = 0; u < G.num_vertices(); ++u )
+			MinVC[u] = cover.contains( u );
+		for ( size_t i = sinceBest.size(); i-- > 0; )
+			MinVC[sinceBest[i].first] = !sinceBest[i].second;
+		sinceBest.clear();
+		logging = false;
+	}
+
+	void logMove( Id u, bool added ){
+		if ( !logging )
+			return;
+		sinceBest.push_back( { u, added } );
+		// Amortize the O(|V|) copy over as many moves
+		if ( sinceBest.size() > G.num_vertices() )
+			materializeBest();
+	}
+
+	// Change the weight of u's neighbors' edges to u by sign * edge weight
+	void shiftNeighbors( Id u, double sign ){
+		Neighbors n = G.neighs( u ), inc = G.incident( u );
+		for ( size_t k = 0; k < n.size(); ++k ){
+			nodeW[n[k]] += sign * weight( inc[k] );
+			outside[n[k]] += sign > 0 ? 1 : -1;
+			if ( cover.contains( n[k] ) ){
+				rescore( n[k] );
+				cover.update( n[k] );
+			}
 		}
+	}
 
-		// Calculate weighted gain for neighbors
+	void addToCover( Id u, IndexedSet<Id> &UncoveredEdges ){
+		rescore( u );
+		cover.push( u );
+		coverW += G.weight( u );
+		logMove( u, true );
+		shiftNeighbors( u, -1.0 );
+		for ( Id e : G.incident( u ) )
+			UncoveredEdges.erase( e );
+	}
+
+	void removeFromCover( Id u, IndexedSet<Id> &UncoveredEdges ){
+		cover.erase( u );
+		coverW -= G.weight( u );
+		logMove( u, false );
+		shiftNeighbors( u, 1.0 );
+		Neighbors n = G.neighs( u ), inc = G.incident( u );
+		for ( size_t k = 0; k < n.size(); ++k )
+			if ( !cover.contains( n[k] ) )
+				UncoveredEdges.insert( inc[k] );
+	}
+
+	// Best exchange of an endpoint of e with a vertex of VC by weighted gain, each side per unit of its vertex weight
+	// The best partner is either the cheapest vertex of VC, or a neighbor in VC whose shared edge adds to the gain
+	// Returns a pair of equal ids if no exchange gains more than -1, as when VC is empty
+	pair<Id, Id> vertexPairToExchange( const Edge &e ){
+		Id elist[2] = { e.first, e.second };
 		double maxGain = -1.0;
 		Id a = 0, b = 0;
 		for ( Id i : elist ){
 			double bWt = nodeW[i];
-			for( Id j : VC ){
-				Edge cand = edge( i, j );
-				if ( taboo_swap == cand )
+			Id j = cover.empty() ? i : cover.top();
+			if ( taboo_swap == edge( i, j ) && cover.size() > 1 )
+				j = cover.second();
+			if ( !cover.empty() && taboo_swap != edge( i, j ) ){
+				double loss = nodeW[j];
+				Id id = G.edge_id( i, j );
+				if ( id != G.num_edges() )
+					loss -= weight( id );
+				double gain = bWt / price( i ) - loss / price( j );
+				if ( gain > maxGain ){
+					maxGain = gain;
+					a = i;
+					b = j;
+				}
+			}
+			Neighbors n = G.neighs( i ), inc = G.incident( i );
+			for ( size_t k = 0; k < n.size(); ++k ){
+				j = n[k];
+				if ( !cover.contains( j ) || taboo_swap == edge( i, j ) )
 					continue;
-				double gain = bWt - nodeW[j];
-				if ( edgeW.find( cand ) != edgeW.end() )
-					gain += edgeW[cand];
+				double gain = bWt / price( i ) - ( nodeW[j] - weight( inc[k] ) ) / price( j );
 				if ( gain > maxGain ){
 					maxGain = gain;
 					a = i;
@@ -83,165 +199,210 @@ public:
 	}
 
 	void ILS(){
-		unordered_set<Edge> UncoveredEdges;
+		IndexedSet<Id> UncoveredEdges( G.num_edges() );
 
-		TimePoint end = chrono::system_clock::now();
-		for ( SecondsDouble elapsed_seconds = end - start; elapsed_seconds.count() <= cutoff;
-			end = chrono::system_clock::now(), elapsed_seconds = end - start ){
+		for ( Deadline deadline( start, cutoff, stop ); !deadline.expired(); ){
 			// While there are no uncovered edges
 			while ( UncoveredEdges.empty() ){
-				if ( VC.size() < MinVC.size() ){
-					MinVC = VC;
-					end = chrono::system_clock::now();
-					elapsed_seconds = end - start;
-					ofs << elapsed_seconds.count() << ',' << ( MinVC.size() ) << '\n';
+				if ( coverW < bestW ){
+					recordBest();
+					incumbent.offer( bestW, thread, stats.get( STEPS ) / max( seconds_since( start ), 1e-9 ) );
 				}
 				// Remove a random vertex
-				auto it = VC.begin();
-				uniform_int_distribution<size_t> idis( 0u, VC.size() - 1u );
-				size_t adv = idis( gen );
-				advance( it, adv );
+				uniform_int_distribution<size_t> idis( 0u, cover.size() - 1u );
 				// Add to uncovered edges if needed
-				for ( Id i : G.vertices[*it].neighs )
-					if ( VC.find( i ) == VC.end() )
-						UncoveredEdges.insert( edge(*it, i) );
+				removeFromCover( cover.at( idis( gen ) ), UncoveredEdges );
 				// Reset these if we finally uncovered an edge
 				if ( !UncoveredEdges.empty() ){
 					taboo_swap = { 0, 0 };
-					for ( auto &p : edgeW )
-						p.second = 0.05;
+					resetWeights();
+					stats.add( RESTARTS );
 				}
-				VC.erase( it );
 			}
 			// Get a random uncovered edge
-			auto it = UncoveredEdges.begin();
 			uniform_int_distribution<size_t> idis( 0u, UncoveredEdges.size() - 1u );
-			size_t adv = idis( gen );
-			advance( it, adv );
-			auto p = vertexPairToExchange( *it );
-			// Erase second
-			VC.erase( p.second );
-			for ( Id i : G.vertices[p.second].neighs )
-				if ( VC.find( i ) == VC.end() )
-					UncoveredEdges.insert( edge( p.second, i ) );
-			// Insert first
-			VC.insert( p.first );
-			for ( Id i : G.vertices[p.first].neighs )
-				UncoveredEdges.erase( edge( p.first, i ) );
-
-			// Add this edge to taboo
-			taboo_swap = edge( p.first, p.second );
+			const Edge &e = G.edges[UncoveredEdges.at( idis( gen ) )];
+			stats.add( STEPS );
+			// With a single vertex in the best cover, removing it leaves nothing to exchange with, so an endpoint comes back
+			if ( cover.empty() ){
+				addToCover( nodeW[e.first] / price( e.first ) >= nodeW[e.second] / price( e.second ) ? e.first : e.second, UncoveredEdges );
+				continue;
+			}
+			auto p = vertexPairToExchange( e );
+			if ( p.first != p.second ){
+				stats.add( SWAPS );
+				// Erase second
+				removeFromCover( p.second, UncoveredEdges );
+				// Insert first
+				addToCover( p.first, UncoveredEdges );
+
+				// Add this edge to taboo
+				taboo_swap = edge( p.first, p.second );
+
+				// A heavier vertex came in, drop the cheapest ones until the cover is lighter than the best again
+				// Without weights the size stays one below the best, so this never runs
+				while ( coverW >= bestW && !cover.empty() )
+					removeFromCover( cover.top(), UncoveredEdges );
+			}
 
 			// Increment weights
-			for ( const Edge &e : UncoveredEdges )
-				++edgeW[e];			
+			stats.add( BUMPS, UncoveredEdges.size() );
+			for ( Id e : UncoveredEdges ){
+				bumpWeight( e );
+				++nodeW[G.edges[e].first];
+				++nodeW[G.edges[e].second];
+			}
 		}
 	}
 
-	vector<Id> solve(){
-		vector<Id> res;
-		
-		// Solve
-		start = chrono::system_clock::now();
-
+	// Search from the initial cover until the cutoff
+	void solve( const vector<Id> &initial ){
 		// Init sol
-		auto sol = getBestHeuristic( G );
-		MinVC.insert( sol.begin(), sol.end() );
-		VC = MinVC;
+		MinVC.assign( G.num_vertices(), false );
+		for ( Id u : initial )
+			MinVC[u] = true;
+		bestW = G.weight( initial );
+		coverW = 0;
 
 		// Init weights
-		nodeW.resize( G.vertices.size(), 0.0 );
-		for ( auto &p : G.edges )
-			edgeW[p.first] = 0.05;
-
-		// Open trace ofstream
-		ofs.open( outfile + ".trace" );
-		TimePoint end = chrono::system_clock::now();
-		SecondsDouble time_elapsed = end - start;
-		ofs << time_elapsed.count() << ',' << MinVC.size() << '\n';
+		nodeW.resize( G.num_vertices(), 0.0 );
+		if ( G.weighted() )
+			score.resize( G.num_vertices(), 0.0 );
+		edgeW.assign( G.num_edges(), 0.05 );
+		edgeEpoch.assign( G.num_edges(), epoch );
+		outside.resize( G.num_vertices() );
+		for ( Id u = 0; u < G.num_vertices(); ++u ){
+			outside[u] = 0;
+			for ( Id v : G.neighs( u ) )
+				outside[u] += !MinVC[v];
+		}
+		cover = IndexedMinHeap<Id, double>( G.num_vertices(), G.weighted() ? score : nodeW );
+		for ( Id u = 0; u < G.num_vertices(); ++u )
+			if ( MinVC[u] ){
+				cover.push( u );
+				coverW += G.weight( u );
+			}
+		resetWeights();
+		incumbent.offer( bestW, thread, 0.0 );
 
-		ILS();
+		if ( G.num_edges() > 0 )
+			ILS();
+	}
 
-		// Close trace ofstream
-		ofs.close();
-
-		// Write best solution found
-		ofstream solfs( outfile + ".sol" );
-		solfs << MinVC.size() << '\n';
-		res.insert( res.end(), MinVC.begin(), MinVC.end() );
-		for ( size_t i = 0; i < res.size(); ++i ){
-			if ( i != 0 )
-				solfs << ',';
-			solfs << ( res[i] + 1 );
-		}
+	// Exchanges tried
+	unsigned long long iterations() const { return stats.get( STEPS ); }
 
+	// Best cover this solver found
+	vector<Id> best(){
+		materializeBest();
+		vector<Id> res;
+		for ( Id u = 0; u < G.num_vertices(); ++u )
+			if ( MinVC[u] )
+				res.push_back( u );
 		return res;
 	}
 };
 
-void localsearch1( Graph &G, int cutoff, int seed ){
-	StochasticSolver solver( G, cutoff, seed );
-	vector<Id> VC = solver.solve();
-
-	G.check_coverage( VC );
-}
-
 // G					- The graph
 // S					- Current solution
 // tigthness			- Number of neighbors that are in S
 // free					- Set of vertices with tightness 0, that are not in S
-// newS/tightness/free	- Candidate solution and its data
+// journal				- Vertices added to (true) or removed from (false) S since the last accepted move
+// cand					- Candidates of two_improv
 // opt					- best solution
+// rows					- adjacency as bit rows if G is dense, null otherwise
+// inS, tight1, busy	- with rows, bit sets of S, of the 1-tight vertices and of the vertices with tightness > 0
+// pairs				- with rows, scratch of the 1-tight neighbors of a candidate
 // gen					- random generator
 // protection			- S cannot be replaced by worse solution for this many rounds
+// stats				- perturb and improve rounds, two-improvements made and rounds whose result was kept
 // cutoff				- cutoff time in seconds
-// start				- starting time point of solver
-// ofs					- ofstream to write to trace
+// start				- starting time point of the run
+// incumbent			- shared best cover of all threads
+// thread				- index of this solver in the run
 class MISSolver{
 private:
-	Graph &G;
-	unordered_set<Id> S, opt, newS, free, newfree;
+	const Graph &G;
+	IndexedSet<Id> S, opt, free, cand;
+
+	vector<int> tightness;
+	vector<pair<Id, bool>> journal;
 
-	vector<int> tightness, newtightness;
+	const BitGraph *rows;
+	BitSet inS, tight1, busy, pairs;
 
 	mt19937 gen;
 	size_t protection;
+	enum { PERTURBATIONS, TWO_IMPROVEMENTS, ACCEPTED };
+	Counters stats;
 
 	double cutoff;
 	TimePoint start;
-	ofstream ofs;
-	string outfile;
+	Incumbent &incumbent;
+	unsigned thread;
 
 public:
-	MISSolver( Graph &G_, double cutoff_, int seed ) : G( G_ ), gen( seed ), cutoff( cutoff_ ){
-		ostringstream oss;
-		oss << "output/" << G.filename.substr( 0, G.filename.size() - 6u ) << "_LS2_" << cutoff << '_' << seed;
-		outfile = oss.str();
+	MISSolver( const Graph &G_, double cutoff_, int seed, TimePoint start_, Incumbent &incumbent_, unsigned thread_, const BitGraph *rows_ = nullptr )
+		: G( G_ ), rows( rows_ ), gen( seed ), stats( "LS2 " + to_string( thread_ ), { "perturbations", "two_improvements", "accepted" } ), cutoff( cutoff_ ), start( start_ ), incumbent( incumbent_ ), thread( thread_ ) {}
+
+	// Bit sets of j after its tightness changed
+	void retight( Id j ){
+		if ( tightness[j] == 1 )
+			tight1.set( j );
+		else
+			tight1.reset( j );
+		if ( tightness[j] != 0 )
+			busy.set( j );
+		else
+			busy.reset( j );
 	}
 
-	void addToSol( Id i, unordered_set<Id> &s, unordered_set<Id> &f, vector<int> &t ){
-		s.insert( i );
-		f.erase( i );
-		for ( Id j : G.vertices[i].neighs ){
-			++t[j];
-			if ( t[j] == 1 )
-				f.erase( j );
+	// record	- false when undoing a journaled change
+	void addToSol( Id i, bool record = true ){
+		S.insert( i );
+		free.erase( i );
+		for ( Id j : G.neighs( i ) ){
+			++tightness[j];
+			if ( tightness[j] == 1 )
+				free.erase( j );
+			if ( rows && tightness[j] <= 2 )
+				retight( j );
 		}
+		if ( rows )
+			inS.set( i );
+		if ( record )
+			journal.push_back( make_pair( i, true ) );
 	}
 
-	void remFromSol( Id i, unordered_set<Id> &s, unordered_set<Id> &f, vector<int> &t ){
-		s.erase( i );
-		f.insert( i );
-		for ( Id j : G.vertices[i].neighs ){
-			--t[j];
-			if ( t[j] == 0 )
-				f.insert( j );
+	void remFromSol( Id i, bool record = true ){
+		S.erase( i );
+		free.insert( i );
+		for ( Id j : G.neighs( i ) ){
+			--tightness[j];
+			if ( tightness[j] == 0 )
+				free.insert( j );
+			if ( rows && tightness[j] <= 1 )
+				retight( j );
 		}
+		if ( rows )
+			inS.reset( i );
+		if ( record )
+			journal.push_back( make_pair( i, false ) );
 	}
 
-	void perturb(){
-		newS = S;
+	// Undo the journal in reverse, back to the last accepted solution
+	void rollback(){
+		while ( !journal.empty() ){
+			pair<Id, bool> change = journal.back();
+			journal.pop_back();
+			if ( change.second )
+				remFromSol( change.first, false );
+			else
+				addToSol( change.first, false );
+		}
+	}
 
+	void perturb(){
 		// Determine k
 		size_t k = 1;
 		uniform_real_distribution<double> dis( 0.0, 1.0 );
@@ -251,181 +412,264 @@ public:
 			k = min( k, S.size() );
 		}
 
-		newtightness = tightness;
-		newfree = free;
 		// S' <- S - { k random elements in S }
-		vector<Id> temp( S.begin(), S.end() );
-		shuffle( temp.begin(), temp.end(), gen );
 		for ( size_t i = 0; i < k; ++i ){
-			remFromSol( temp[i], newS, newfree, newtightness );
+			uniform_int_distribution<size_t> sdis( 0u, S.size()-1u );
+			remFromSol( S.at( sdis( gen ) ) );
 		}
 		
 		// Insert at most k new free vertices
-		auto it = newfree.begin();
-		uniform_int_distribution<size_t> idis( 0u, newfree.size()-1u );
-		size_t adv = idis( gen );
-		advance( it, adv );
-		addToSol( *it, newS, newfree, newtightness );
-		while ( --k && !newfree.empty() ){
+		uniform_int_distribution<size_t> idis( 0u, free.size()-1u );
+		addToSol( free.at( idis( gen ) ) );
+		while ( --k && !free.empty() ){
 			// Vertex in free has distance 2 from solution vertices if it has a neighbor with non-zero tightness
-			for ( Id u : newfree ){
+			for ( Id u : free ){
 				bool good = false;
-				for ( Id v : G.vertices[u].neighs ){
-					good |= newtightness[v] != 0;
-					if ( good ) break;
-				}
+				if ( rows )
+					good = and_any( rows->row( u ), busy.data(), busy.words() );
+				else
+					for ( Id v : G.neighs( u ) ){
+						good |= tightness[v] != 0;
+						if ( good ) break;
+					}
 				if ( good ){
-					addToSol( u, newS, newfree, newtightness );
+					addToSol( u );
 					break;
 				}
 			}
 		}
 	}
 
-	void swapSols(){
-		newS.swap( S );
-		newfree.swap( free );
-		newtightness.swap( tightness );
+	// Only solution vertices near a change can have gained a 2-improvement:
+	// the changed vertex itself, and the solution neighbor of each 1-tight vertex next to it
+	void seedCandidates(){
+		for ( const pair<Id, bool> &change : journal ){
+			Id v = change.first;
+			if ( S.contains( v ) )
+				cand.insert( v );
+			for ( Id w : G.neighs( v ) ){
+				if ( tightness[w] != 1 || S.contains( w ) )
+					continue;
+				if ( rows ){
+					size_t x = and_find( rows->row( w ), inS.data(), 0, inS.words() );
+					if ( x != bit_npos )
+						cand.insert( x );
+					continue;
+				}
+				for ( Id x : G.neighs( w ) )
+					if ( S.contains( x ) ){
+						cand.insert( x );
+						break;
+					}
+			}
+		}
 	}
 
-	void two_improv(){
-		// Initially all members of the solution are candidates
-		unordered_set<Id> cand = newS;
+	// The first 1-tight neighbor a of x, in neighbor order, with a later 1-tight neighbor b that is not adjacent to it
+	bool findPair( Id x, Id &a, Id &b ){
+		// With bit rows, b is the first bit past a of pairs & ~row( a )
+		if ( rows ){
+			and_store( pairs.data(), rows->row( x ), tight1.data(), pairs.words() );
+			for ( size_t i = and_find( pairs.data(), pairs.data(), 0, pairs.words() ); i != bit_npos;
+				i = and_find( pairs.data(), pairs.data(), i + 1, pairs.words() ) ){
+				size_t j = andnot_find( pairs.data(), rows->row( i ), i + 1, pairs.words() );
+				if ( j != bit_npos ){
+					a = i;
+					b = j;
+					return true;
+				}
+			}
+			return false;
+		}
+		Neighbors xneighs = G.neighs( x );
+		for ( auto it1 = xneighs.begin(), et = xneighs.end(); it1 != et; ++it1 ){
+			if ( tightness[*it1] != 1 )
+				continue;
+			for ( auto it2 = it1; it2 != et; ++it2 ){
+				if ( it1 == it2 || tightness[*it2] != 1 
+					 || G.adjacent( *it1, *it2 ) )
+					continue;
+				a = *it1;
+				b = *it2;
+				return true;
+			}
+		}
+		return false;
+	}
 
+	void two_improv(){
 		// While there are candidates
 		while ( !cand.empty() ){
-			Id x = *cand.begin();
+			Id x = cand.back();
 			cand.erase( x );
+			if ( !S.contains( x ) )
+				continue;
 			// Find replacements among x's neighbors that are 1-tight, not neighbors of each other
-			for ( auto it1 = G.vertices[x].neighs.begin(), et = G.vertices[x].neighs.end(); it1 != et; ++it1 ){
-				if ( newtightness[*it1] != 1 )
-					continue;
-				bool found = false;
-				for ( auto it2 = it1; it2 != et; ++it2 ){
-					if ( it1 == it2 || newtightness[*it2] != 1 
-						 || G.vertices[*it1].neighs.find( *it2 ) != G.vertices[*it1].neighs.end() )
-						continue;
-					// Found
-					remFromSol( x, newS, newfree, newtightness );
-					addToSol( *it1, newS, newfree, newtightness );
-					addToSol( *it2, newS, newfree, newtightness );
-
-					// Add to candidates
-					cand.insert( *it1 );
-					cand.insert( *it2 );
-					// If a neighbor of x became 1-tight due to x's removal
-					for ( Id xn : G.vertices[x].neighs )
-						if ( newtightness[xn] == 1 )
-							// Then add the one neighbor that is in the solution to cand
-							for ( Id xnn : G.vertices[xn].neighs )
-								if ( xnn != *it1 && xnn != *it2 && newS.find( xnn ) != newS.end() )
-									cand.insert( xnn );
-					// Terminate loops
-					found = true;
-					break;
-				}
-				if ( found )
-					break;
-			}			
+			Id a, b;
+			if ( !findPair( x, a, b ) )
+				continue;
+			stats.add( TWO_IMPROVEMENTS );
+			remFromSol( x );
+			addToSol( a );
+			addToSol( b );
+
+			// Add to candidates
+			cand.insert( a );
+			cand.insert( b );
+			// If a neighbor of x became 1-tight due to x's removal
+			for ( Id xn : G.neighs( x ) )
+				if ( tightness[xn] == 1 )
+					// Then add the one neighbor that is in the solution to cand
+					for ( Id xnn : G.neighs( xn ) )
+						if ( xnn != a && xnn != b && S.contains( xnn ) )
+							cand.insert( xnn );
 		}
 	}
 
 	void ILS(){
-		// Try to improve initial solution
-		swapSols();
+		// Try to improve initial solution, all members of the solution are candidates
+		for ( Id v : S )
+			cand.insert( v );
 		two_improv();
-		swapSols();
+		journal.clear();
 		protection = S.size();
+		// Nothing to perturb in a graph without vertices, as a fully reduced kernel is
+		if ( S.empty() )
+			return;
 
-		TimePoint end = chrono::system_clock::now();
-		for ( SecondsDouble elapsed_seconds = end - start; elapsed_seconds.count() <= cutoff; 
-			end = chrono::system_clock::now(), elapsed_seconds = end - start ){			
+		for ( Deadline deadline( start, cutoff ); !deadline.expired(); ){
 			
+			// Perturb and improve in place, the journal can take it back
+			size_t size = S.size();
+			stats.add( PERTURBATIONS );
 			perturb();
-
+			seedCandidates();
 			two_improv();
 
-			// Decide to swap it
-			if ( newS.size() > S.size() ){
-				swapSols();
+			// Decide to keep it
+			if ( S.size() > size ){
+				stats.add( ACCEPTED );
+				journal.clear();
 				protection = S.size();
 				if ( S.size() > opt.size() ){
 					opt = S;
-					end = chrono::system_clock::now();
-					elapsed_seconds = end - start;
-					ofs << elapsed_seconds.count() << ',' << (G.vertices.size() - opt.size()) << '\n';
+					incumbent.offer( G.num_vertices() - opt.size(), thread );
 				}
 			}
 			else{
-				if ( protection-- != 0 )
+				if ( protection-- != 0 ){
+					rollback();
 					continue;
+				}
 				uniform_real_distribution<double> dis( 0.0, 1.0 );
-				if ( dis( gen ) <= 1.0 / ( 1.0 + ( S.size() - newS.size() )*( opt.size() - newS.size() ) ) ){
-					swapSols();
+				if ( dis( gen ) <= 1.0 / ( 1.0 + ( size - S.size() )*( opt.size() - S.size() ) ) ){
+					stats.add( ACCEPTED );
+					journal.clear();
 					protection = S.size();
 				}
+				else
+					rollback();
 			}
 		}		
 	}
 
-	vector<Id> solve(){
-		vector<Id> res;
-
-		// Solve
-		start = chrono::system_clock::now();
-
-		vector<Id> sol = getBestHeuristic( G );
-		opt.reserve( G.vertices.size() );
+	// Search from the initial cover until the cutoff
+	void solve( const vector<Id> &initial ){
+		opt = IndexedSet<Id>( G.num_vertices() );
+		free = IndexedSet<Id>( G.num_vertices() );
+		cand = IndexedSet<Id>( G.num_vertices() );
 		// Best solution
-		for ( size_t i = 0; i < G.vertices.size(); ++i )
+		for ( size_t i = 0; i < G.num_vertices(); ++i )
 			opt.insert( i );
-		for ( Id i : sol )
+		for ( Id i : initial )
 			opt.erase( i );
 		// Current solution
 		S = opt;
 
 		// Initialize tightness
-		tightness.resize( G.vertices.size(), 0 );
-		for ( size_t i = 0; i < G.vertices.size(); ++i ){
-			if ( S.find( i ) != S.end() )
-				for ( Id j : G.vertices[i].neighs )
-					++tightness[j];
+		tightness.resize( G.num_vertices(), 0 );
+		if ( rows ){
+			inS = tight1 = busy = pairs = BitSet( G.num_vertices() );
+			for ( Id i : S )
+				inS.set( i );
+			for ( Id j = 0; j < G.num_vertices(); ++j ){
+				tightness[j] = and_count( rows->row( j ), inS.data(), inS.words() );
+				retight( j );
+			}
 		}
+		else
+			for ( size_t i = 0; i < G.num_vertices(); ++i ){
+				if ( S.contains( i ) )
+					for ( Id j : G.neighs( i ) )
+						++tightness[j];
+			}
 		// Initialize free
-		for ( size_t i = 0; i < G.vertices.size(); ++i )
-			if ( tightness[i] == 0 && S.find( i ) == S.end() )
+		for ( size_t i = 0; i < G.num_vertices(); ++i )
+			if ( tightness[i] == 0 && !S.contains( i ) )
 				free.insert( i );
 
-		// Open trace ofstream
-		ofs.open( outfile + ".trace" );
-		TimePoint end = chrono::system_clock::now();
-		SecondsDouble time_elapsed = end - start;
-		ofs << time_elapsed.count() << ',' << ( G.vertices.size() - opt.size() ) << '\n';
+		incumbent.offer( G.num_vertices() - opt.size(), thread );
 		ILS();
+	}
 
-		// Close trace ofstream
-		ofs.close();
-
-		// Write best solution found
-		ofstream solfs( outfile + ".sol" );
-		solfs << ( G.vertices.size() - opt.size() ) << '\n';
-		res.reserve( G.vertices.size() - opt.size() );
-		for ( size_t i = 0; i < G.vertices.size(); ++i ){
-			if ( opt.find( i ) != opt.end() )
-				continue;
-			if ( !res.empty() )
-				solfs << ',';
-			solfs << ( i + 1 );
-			res.push_back( i );
-		}
+	// Perturb and improve rounds
+	unsigned long long iterations() const { return stats.get( PERTURBATIONS ); }
 
+	// Best cover this solver found, the complement of opt
+	vector<Id> best(){
+		vector<Id> res;
+		for ( Id i = 0; i < G.num_vertices(); ++i )
+			if ( !opt.contains( i ) )
+				res.push_back( i );
 		return res;
 	}
 };
 
-void localsearch2( Graph &G, int cutoff, int seed ){
-	MISSolver solver( G, cutoff, seed );
-	vector<Id> VC = solver.solve();
+// Run one solver per thread with seeds seed, seed + 1, ... from the best heuristic cover
+// All of them share G, and the best cover any of them found is written
+// extra	- more arguments of the Solver constructor
+template <class Solver, class... Extra>
+static vector<Id> portfolio( const Graph &G, const string &alg, int cutoff, int seed, unsigned threads, const Kernel *kernel, Extra... extra ){
+	TimePoint start = Clock::now();
+	threads = max( 1u, threads );
+	ostringstream oss;
+	oss << "output/" << G.filename.substr( 0, G.filename.size() - 6u ) << '_' << alg << '_' << cutoff << '_' << seed;
+	if ( threads > 1 )
+		oss << '-' << ( seed + threads - 1 );
+	Incumbent incumbent( oss.str(), start, kernel );
+
+	vector<Id> initial = getBestHeuristic( G );
+	vector<unique_ptr<Solver>> solvers;
+	for ( unsigned t = 0; t < threads; ++t )
+		solvers.emplace_back( new Solver( G, cutoff, seed + t, start, incumbent, t, extra... ) );
+	parallel_for( threads, threads, [&]( unsigned, size_t b, size_t e ){
+		for ( size_t t = b; t < e; ++t )
+			solvers[t]->solve( initial );
+	} );
+	unsigned long long steps = 0;
+	for ( const unique_ptr<Solver> &s : solvers )
+		steps += s->iterations();
+	cout << alg << ": " << steps << " steps (" << steps / max( seconds_since( start ), 1e-9 ) << " steps/s)\n";
+
+	return incumbent.write_solution( solvers[incumbent.best_thread()]->best() );
+}
+
+vector<Id> localsearch1( const Graph &G, int cutoff, int seed, unsigned threads, const Kernel *kernel ){
+	return portfolio<StochasticSolver>( G, "LS1", cutoff, seed, threads, kernel );
+}
+
+vector<Id> localsearch2( const Graph &G, int cutoff, int seed, unsigned threads, const Kernel *kernel, double dense ){
+	// One copy of the rows, the solvers only read it
+	unique_ptr<BitGraph> rows;
+	if ( BitGraph::dense( G, dense ) ){
+		rows.reset( new BitGraph( G ) );
+		cout << "LS2: bit rows, " << bit_kernels() << " kernels\n";
+	}
+	return portfolio<MISSolver>( G, "LS2", cutoff, seed, threads, kernel, static_cast<const BitGraph *>( rows.get() ) );
+}
 
-	G.check_coverage( VC );
+vector<Id> improve_cover( const Graph &G, const vector<Id> &initial, double cutoff, int seed, Incumbent &incumbent, const atomic<bool> &stop ){
+	StochasticSolver solver( G, cutoff, seed, Clock::now(), incumbent, 0, &stop );
+	solver.solve( initial );
+	return solver.best();
 }
\ No newline at end of file
@@ -6,6 +6,10 @@
 #include "bnb.h"
 #include "heuristic.h"
 #include "localsearch.h"
+#include "bounds.h"
+#include "kernel.h"
+#include "service.h"
+#include "stats.h"
 
 using namespace std;
 
@@ -23,6 +27,13 @@ public:
 		return default_val;
 	}
 
+	bool get_opt_flag( string s ){
+		for ( int i = 0; i < _argc; ++i )
+			if ( s == _argv[i] )
+				return true;
+		return false;
+	}
+
 	string get_opt_strarg( string s, string default_val ){
 		for ( int i = 0; i < _argc; ++i )
 			if ( s == _argv[i] && i + 1 < _argc )
@@ -35,7 +46,11 @@ public:
 int main( int argc, char* argv[] ){
 	CmdlineParser parser( argc, argv );
 
-	Graph G = Graph( parser.get_opt_strarg( "-inst", "input.txt" ) );
+	Graph G( parser.get_opt_strarg( "-inst", "input.txt" ), parser.get_opt_intarg( "-load-threads", 1 ) );
+
+	string dumpfile = parser.get_opt_strarg( "-dump-bin", "" );
+	if ( !dumpfile.empty() )
+		G.dump( dumpfile );
 
     int cutoff = parser.get_opt_intarg( "-time", 600 );
 
@@ -43,14 +58,95 @@ int main( int argc, char* argv[] ){
 
     int seed = parser.get_opt_intarg( "-seed", 0 );
 
+    unsigned threads = parser.get_opt_intarg( "-threads", 1 );
+
+    string bound = parser.get_opt_strarg( "-bound", "matching" );
+    if ( !known_bound( bound ) ){
+		cout << "Unknown lower bound " << bound << "!\n";
+		return 1;
+    }
+    string rule = parser.get_opt_strarg( "-branch", "maxdeg" );
+    if ( !known_rule( rule ) ){
+		cout << "Unknown branching rule " << rule << "!\n";
+		return 1;
+    }
+
+    // Solver counters, sampled to a file or stderr while the algorithm runs
+    string statsfile = parser.get_opt_strarg( "-stats", "" );
+    unique_ptr<StatsSampler> sampler;
+    if ( !statsfile.empty() )
+		sampler.reset( new StatsSampler( statsfile, parser.get_opt_intarg( "-stats-ms", 1000 ) / 1000.0 ) );
+
+    // Only the parts that hold for any vertex weights are used on a weighted graph
+    bool reduced = parser.get_opt_flag( "-reduce" ), nt = parser.get_opt_flag( "-nt" );
+    if ( G.weighted() ){
+		if ( reduced || nt ){
+			cout << "Weighted graph, solving it without a kernel\n";
+			reduced = nt = false;
+		}
+		if ( bound == "greedy" ){
+			cout << "Weighted graph, using the matching bound\n";
+			bound = "matching";
+		}
+		if ( rule == "mirror" ){
+			cout << "Weighted graph, branching on maxdeg\n";
+			rule = "maxdeg";
+		}
+		if ( method == "LS2" ){
+			cout << "Weighted graph, running LS1\n";
+			method = "LS1";
+		}
+    }
+
+    // The graph changes under the service, so it works on the whole of it
+    if ( method == "Serve" ){
+		serve( G, cutoff, seed, cin, cout );
+		return 0;
+    }
+
+    // Solve a kernel instead, its covers are lifted back on output
+    // The reduction rules run Nemhauser-Trotter themselves, so -reduce wins over -nt
+    unique_ptr<Kernel> kernel;
+    if ( reduced ){
+		kernel = reduce( G );
+		cout << "Reduced kernel: |V| = " << kernel->graph->num_vertices() << ", |E| = " << kernel->graph->num_edges()
+			<< ", " << kernel->forced.size() << " vertices forced into the cover, " << kernel->folds.size() << " folds, "
+			<< G.num_vertices() - kernel->forced.size() - 2 * kernel->folds.size() - kernel->graph->num_vertices() << " excluded, in "
+			<< kernel->seconds << " s\n";
+    }
+    else if ( nt ){
+		kernel = nemhauser_trotter( G );
+		cout << "NT kernel: |V| = " << kernel->graph->num_vertices() << ", |E| = " << kernel->graph->num_edges()
+			<< ", " << kernel->forced.size() << " vertices forced into the cover, "
+			<< G.num_vertices() - kernel->forced.size() - kernel->graph->num_vertices() << " excluded, in "
+			<< kernel->seconds << " s\n";
+    }
+    // Small components are solved exactly up front, the algorithm only sees the large ones
+    Id small = parser.get_opt_intarg( "-components", 0 );
+    if ( small > 0 ){
+		unique_ptr<Kernel> split = solve_small_components( kernel ? *kernel->graph : G, small, cutoff );
+		cout << "Components: " << split->forced.size() << " vertices forced by components of at most " << small << " vertices, |V| = "
+			<< split->graph->num_vertices() << ", |E| = " << split->graph->num_edges() << " left, in " << split->seconds << " s\n";
+		if ( kernel )
+			kernel->compose( move( split ) );
+		else
+			kernel = move( split );
+    }
+    const Graph &H = kernel ? *kernel->graph : G;
+
+    vector<Id> VC;
     if ( method == "BnB" )
-		branch_and_bound( G, cutoff );
+		VC = branch_and_bound( H, cutoff, threads, bound, rule, kernel.get() );
 	else if ( method == "Approx" )
-		heuristic( G );
+		VC = heuristic( H, threads, kernel.get() );
 	else if ( method == "LS1" )
-		localsearch1( G, cutoff, seed );
+		VC = localsearch1( H, cutoff, seed, threads, kernel.get() );
 	else if ( method == "LS2" )
-		localsearch2( G, cutoff, seed );
+		VC = localsearch2( H, cutoff, seed, threads, kernel.get(), stod( parser.get_opt_strarg( "-dense", "0.03125" ) ) );
+	else
+		return 0;
+
+	G.check_coverage( VC );
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "service.h"
+#include "heuristic.h"
+#include "localsearch.h"
+#include "incumbent.h"
+#include <algorithm>
+#include <sstream>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+// Lines of the input, read by a thread of their own so that the search can stop as soon as one arrives
+// lines	- read but not taken yet
+// closed	- the input is at its end
+// stop		- set while lines are waiting and once the input is closed
+class LineReader{
+private:
+	mutex lock;
+	condition_variable arrived;
+	deque<string> lines;
+	bool closed;
+	thread reader;
+
+public:
+	atomic<bool> stop;
+
+	LineReader( istream &in ) : closed( false ), stop( false ){
+		reader = thread( [this, &in](){
+			string line;
+			while ( getline( in, line ) ){
+				lock_guard<mutex> guard( lock );
+				lines.push_back( line );
+				stop = true;
+				arrived.notify_one();
+			}
+			lock_guard<mutex> guard( lock );
+			closed = true;
+			stop = true;
+			arrived.notify_one();
+		} );
+	}
+
+	~LineReader(){ reader.join(); }
+
+	// Moves the waiting lines to batch, waiting for one first if wait is set, false once the input is closed
+	bool take( deque<string> &batch, bool wait ){
+		unique_lock<mutex> guard( lock );
+		if ( wait )
+			arrived.wait( guard, [this](){ return !lines.empty() || closed; } );
+		batch.swap( lines );
+		stop = closed;
+		return !closed;
+	}
+};
+
+// The graph under updates and its cover
+// lists	- neighbors of each vertex, unordered, the graph is rebuilt from them after a batch
+// weights	- of each vertex, empty if the input is unweighted
+// added	- edges inserted since the last rebuild, the only ones that can be uncovered
+// graph	- the input graph or the last rebuilt one, which rebuilt owns
+// in		- whether each vertex is in the cover
+class CoverService{
+private:
+	string filename;
+	vector<vector<Id>> lists;
+	vector<Id> weights;
+	vector<Edge> added;
+	bool changed;
+	const Graph *graph;
+	unique_ptr<Graph> rebuilt;
+	vector<bool> in;
+
+	void grow( Id n ){
+		if ( n <= lists.size() )
+			return;
+		lists.resize( n );
+		in.resize( n, false );
+		if ( !weights.empty() )
+			weights.resize( n, 1 );
+	}
+
+	static bool unlink( vector<Id> &list, Id v ){
+		vector<Id>::iterator it = find( list.begin(), list.end(), v );
+		if ( it == list.end() )
+			return false;
+		*it = list.back();
+		list.pop_back();
+		return true;
+	}
+
+	// Edges covered per unit of weight
+	double rank( Id v ) const { return static_cast<double>( graph->degree( v ) ) / max( graph->weight( v ), Id( 1 ) ); }
+
+public:
+	CoverService( const Graph &G )
+		: filename( G.filename ), lists( G.num_vertices() ), weights( G.weights.begin(), G.weights.end() ), changed( false ),
+		graph( &G ), in( G.num_vertices(), false ){
+		for ( Id v = 0; v < G.num_vertices(); ++v )
+			lists[v].assign( G.neighs( v ).begin(), G.neighs( v ).end() );
+		for ( Id v : getBestHeuristic( G ) )
+			in[v] = true;
+	}
+
+	// op	- 'a' inserts edge {u, v}, 'd' deletes it, either is a no-op if the edge already is or is not there
+	void update( char op, Id u, Id v ){
+		if ( u == v )
+			return;
+		grow( max( u, v ) + 1 );
+		if ( op == 'a' && find( lists[u].begin(), lists[u].end(), v ) == lists[u].end() ){
+			lists[u].push_back( v );
+			lists[v].push_back( u );
+			added.push_back( edge( u, v ) );
+			changed = true;
+		}
+		else if ( op == 'd' && unlink( lists[u], v ) ){
+			unlink( lists[v], u );
+			changed = true;
+		}
+	}
+
+	// Applies the updates so far, true if there were any
+	bool rebuild(){
+		if ( !changed )
+			return false;
+		rebuilt.reset( new Graph( lists, filename, weights ) );
+		graph = rebuilt.get();
+		for ( const Edge &e : added )
+			if ( !in[e.first] && !in[e.second] && graph->adjacent( e.first, e.second ) )
+				in[rank( e.first ) >= rank( e.second ) ? e.first : e.second] = true;
+		added.clear();
+		changed = false;
+		return true;
+	}
+
+	vector<Id> cover() const {
+		vector<Id> VC;
+		for ( Id v = 0; v < in.size(); ++v )
+			if ( in[v] )
+				VC.push_back( v );
+		return VC;
+	}
+
+	// full	- list the cover too
+	void answer( ostream &out, bool full ) const {
+		vector<Id> VC = cover();
+		out << "cover " << graph->weight( VC ) << ' ' << VC.size() << '\n';
+		if ( full ){
+			for ( size_t i = 0; i < VC.size(); ++i ){
+				if ( i != 0 )
+					out << ',';
+				out << ( VC[i] + 1 );
+			}
+			out << '\n';
+		}
+		out.flush();
+	}
+
+	// LS1 from the current cover, true if it ran until the cutoff rather than being stopped
+	bool improve( double cutoff, int seed, Incumbent &incumbent, const atomic<bool> &stop ){
+		vector<Id> VC = improve_cover( *graph, cover(), cutoff, seed, incumbent, stop );
+		fill( in.begin(), in.end(), false );
+		for ( Id v : VC )
+			in[v] = true;
+		return !stop;
+	}
+};
+
+void serve( const Graph &G, int cutoff, int seed, istream &in, ostream &out ){
+	ostringstream oss;
+	oss << "output/" << G.filename.substr( 0, G.filename.size() - 6u ) << "_Service_" << cutoff << '_' << seed;
+	Incumbent incumbent( oss.str(), Clock::now() );
+	CoverService service( G );
+
+	// Answers go out flushed, reading must not flush them from the other thread
+	in.tie( nullptr );
+	LineReader reader( in );
+	bool open = true, idle = false;
+	for ( unsigned runs = 0; open; ){
+		deque<string> batch;
+		open = reader.take( batch, idle );
+		for ( const string &line : batch ){
+			istringstream iss( line );
+			char op = 0;
+			long long u = 0, v = 0;
+			iss >> op;
+			if ( op == 'a' || op == 'd' ){
+				if ( iss >> u >> v && u > 0 && v > 0 )
+					service.update( op, u - 1, v - 1 );
+				else
+					out << "bad edge: " << line << '\n';
+			}
+			else if ( op == 's' || op == 'q' ){
+				if ( service.rebuild() )
+					incumbent.reset();
+				service.answer( out, op == 'q' );
+			}
+			else if ( op != 0 )
+				out << "unknown command: " << line << '\n';
+		}
+		out.flush();
+		if ( service.rebuild() ){
+			incumbent.reset();
+			idle = false;
+		}
+		if ( open && !idle )
+			idle = service.improve( cutoff, seed + runs++, incumbent, reader.stop );
+	}
+	incumbent.write_solution( service.cover() );
+}
\ No newline at end of file
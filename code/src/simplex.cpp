@@ -7,6 +7,7 @@ http://college.cengage.com/mathematics/larson/elementary_linear/4e/shared/downlo
 */
 
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <fstream>
@@ -267,6 +268,308 @@ bool simplex( Tableau &tab ) {
     return false;
 }
 
+const size_t RevisedSimplex::npos;
+
+RevisedSimplex::RevisedSimplex( const vector<double> &b_, size_t refactor_ )
+    : m( b_.size() ), b( b_ ), col_start( 1, 0 ), refactor( max( refactor_, size_t( 1 ) ) ), updates( 0 ), price_start( 0 ),
+    work( m, 0.0 ), dual( m, 0.0 ), inlist( m, 0 ) {}
+
+size_t RevisedSimplex::add_column( double c, const vector<pair<size_t, double>> &entries ){
+    for ( const pair<size_t, double> &e : entries ){
+        col_row.push_back( e.first );
+        col_val.push_back( e.second );
+    }
+    col_start.push_back( col_row.size() );
+    cost.push_back( c );
+    return cost.size() - 1;
+}
+
+void RevisedSimplex::touch( size_t i ){
+    if ( !inlist[i] ){
+        inlist[i] = 1;
+        nonzeros.push_back( i );
+    }
+}
+
+void RevisedSimplex::clear_work(){
+    for ( size_t i : nonzeros ){
+        work[i] = 0.0;
+        inlist[i] = 0;
+    }
+    nonzeros.clear();
+}
+
+void RevisedSimplex::load_column( size_t j ){
+    if ( j >= cols() ){
+        work[j - cols()] = 1.0;
+        touch( j - cols() );
+        return;
+    }
+    for ( size_t k = col_start[j]; k < col_start[j + 1]; ++k ){
+        work[col_row[k]] = col_val[k];
+        touch( col_row[k] );
+    }
+}
+
+// work <- B^-1 work, only etas whose pivot row is nonzero do anything
+void RevisedSimplex::ftran(){
+    for ( const Eta &eta : etas ){
+        double xp = work[eta.row];
+        if ( xp == 0.0 )
+            continue;
+        xp /= eta.pivot;
+        work[eta.row] = xp;
+        for ( size_t k = eta.first; k < eta.last; ++k ){
+            work[eta_entries[k].first] -= eta_entries[k].second * xp;
+            touch( eta_entries[k].first );
+        }
+    }
+}
+
+// dual <- c_B^T B^-1
+void RevisedSimplex::btran(){
+    for ( size_t r = 0; r < m; ++r )
+        dual[r] = head[r] < cols() ? cost[head[r]] : 0.0;
+    for ( size_t e = etas.size(); e-- > 0; ){
+        const Eta &eta = etas[e];
+        double y = dual[eta.row];
+        for ( size_t k = eta.first; k < eta.last; ++k )
+            y -= eta_entries[k].second * dual[eta_entries[k].first];
+        dual[eta.row] = y / eta.pivot;
+    }
+}
+
+// Append the eta column of the transformed column in work, pivoting on row
+void RevisedSimplex::add_eta( size_t row ){
+    Eta eta;
+    eta.row = row;
+    eta.pivot = work[row];
+    eta.first = eta_entries.size();
+    for ( size_t i : nonzeros )
+        if ( i != row && !equal( work[i], 0.0 ) )
+            eta_entries.push_back( make_pair( i, work[i] ) );
+    eta.last = eta_entries.size();
+    etas.push_back( eta );
+}
+
+// Rebuild the eta file from the basic columns and recompute xB
+// Falls back to the all slack basis if the basis turned out numerically singular or infeasible
+void RevisedSimplex::reinvert(){
+    size_t n = cols();
+    updates = 0;
+    etas.clear();
+    eta_entries.clear();
+    vector<size_t> structural;
+    vector<char> available( m, 0 );
+    for ( size_t r = 0; r < m; ++r ){
+        if ( head[r] < n )
+            structural.push_back( head[r] );
+        available[r] = pos[n + r] == npos;
+    }
+    // Basic slacks go back to their own rows, the structural columns take the others
+    fill( pos.begin(), pos.end(), npos );
+    for ( size_t r = 0; r < m; ++r )
+        if ( !available[r] ){
+            head[r] = n + r;
+            pos[n + r] = r;
+        }
+
+    // Row singletons first: a column pivoted on a row that no remaining column touches
+    // passes the earlier etas unchanged, so the triangular part of the basis needs no ftran and causes no fill in
+    vector<size_t> count( m, 0 ), rstart( m + 1, 0 ), rcols, singletons;
+    for ( size_t q : structural )
+        for ( size_t k = col_start[q]; k < col_start[q + 1]; ++k )
+            if ( available[col_row[k]] )
+                ++rstart[col_row[k] + 1];
+    for ( size_t r = 0; r < m; ++r ){
+        count[r] = rstart[r + 1];
+        rstart[r + 1] += rstart[r];
+        if ( count[r] == 1 )
+            singletons.push_back( r );
+    }
+    rcols.resize( rstart[m] );
+    for ( size_t q : structural )
+        for ( size_t k = col_start[q]; k < col_start[q + 1]; ++k )
+            if ( available[col_row[k]] )
+                rcols[rstart[col_row[k] + 1] - count[col_row[k]]--] = q;
+    for ( size_t r = 0; r < m; ++r )
+        count[r] = rstart[r + 1] - rstart[r];
+    while ( !singletons.empty() ){
+        size_t r = singletons.back();
+        singletons.pop_back();
+        if ( !available[r] || count[r] != 1 )
+            continue;
+        size_t q = npos;
+        for ( size_t k = rstart[r]; k < rstart[r + 1] && q == npos; ++k )
+            if ( pos[rcols[k]] == npos )
+                q = rcols[k];
+        if ( q == npos )
+            continue;
+        load_column( q );
+        available[r] = 0;
+        head[r] = q;
+        pos[q] = r;
+        add_eta( r );
+        clear_work();
+        for ( size_t k = col_start[q]; k < col_start[q + 1]; ++k )
+            if ( available[col_row[k]] && --count[col_row[k]] == 1 )
+                singletons.push_back( col_row[k] );
+    }
+
+    bool ok = true;
+    for ( size_t q : structural ){
+        if ( pos[q] != npos )
+            continue;
+        load_column( q );
+        ftran();
+        size_t p = npos;
+        for ( size_t i : nonzeros )
+            if ( available[i] && fabs( work[i] ) > epsilon && ( p == npos || fabs( work[i] ) > fabs( work[p] ) ) )
+                p = i;
+        if ( p == npos ){
+            clear_work();
+            ok = false;
+            break;
+        }
+        available[p] = 0;
+        head[p] = q;
+        pos[q] = p;
+        add_eta( p );
+        clear_work();
+    }
+
+    if ( ok ){
+        for ( size_t r = 0; r < m; ++r ){
+            work[r] = b[r];
+            touch( r );
+        }
+        ftran();
+        for ( size_t r = 0; r < m; ++r ){
+            xB[r] = work[r];
+            ok &= xB[r] > -epsilon;
+            xB[r] = max( xB[r], 0.0 );
+        }
+        clear_work();
+    }
+    if ( !ok ){
+        etas.clear();
+        eta_entries.clear();
+        fill( pos.begin(), pos.end(), npos );
+        for ( size_t r = 0; r < m; ++r ){
+            head[r] = n + r;
+            pos[n + r] = r;
+            xB[r] = b[r];
+        }
+    }
+}
+
+// Partial pricing: entering column with the largest reduced cost among the first chunk of candidates
+// found from price_start on, npos if the basis is optimal
+size_t RevisedSimplex::price(){
+    btran();
+    size_t n = cols(), total = n + m;
+    size_t chunk = max( size_t( 64 ), total / 16 );
+    size_t best = npos;
+    double bestd = epsilon;
+    for ( size_t scanned = 0; scanned < total && ( best == npos || scanned < chunk ); ++scanned ){
+        size_t j = ( price_start + scanned ) % total;
+        if ( pos[j] != npos )
+            continue;
+        double d;
+        if ( j < n ){
+            d = cost[j];
+            for ( size_t k = col_start[j]; k < col_start[j + 1]; ++k )
+                d -= dual[col_row[k]] * col_val[k];
+        }
+        else
+            d = -dual[j - n];
+        if ( d > bestd ){
+            bestd = d;
+            best = j;
+        }
+    }
+    if ( best != npos )
+        price_start = ( best + 1 ) % total;
+    return best;
+}
+
+void RevisedSimplex::init(){
+    size_t n = cols();
+    head.resize( m );
+    pos.assign( n + m, npos );
+    xB = b;
+    for ( size_t r = 0; r < m; ++r ){
+        head[r] = n + r;
+        pos[n + r] = r;
+    }
+}
+
+void RevisedSimplex::crash( const vector<pair<size_t, size_t>> &basis ){
+    size_t n = cols();
+    if ( head.empty() )
+        init();
+    for ( const pair<size_t, size_t> &cr : basis ){
+        if ( pos[cr.first] != npos || head[cr.second] != n + cr.second )
+            continue;
+        pos[n + cr.second] = npos;
+        head[cr.second] = cr.first;
+        pos[cr.first] = cr.second;
+    }
+    reinvert();
+}
+
+bool RevisedSimplex::solve( size_t max_iter, Deadline *deadline ){
+    if ( head.empty() )
+        init();
+    for ( size_t iter = 0; iter < max_iter; ++iter ){
+        if ( deadline && deadline->expired() )
+            return false;
+        size_t q = price();
+        if ( q == npos )
+            return true;
+
+        // Ratio test on the transformed column, ties go to the larger pivot
+        load_column( q );
+        ftran();
+        size_t p = npos;
+        double theta = 0.0;
+        for ( size_t r : nonzeros ){
+            if ( work[r] <= epsilon )
+                continue;
+            double ratio = xB[r] / work[r];
+            if ( p == npos || ratio < theta - epsilon || ( ratio <= theta + epsilon && work[r] > work[p] ) ){
+                p = r;
+                theta = ratio;
+            }
+        }
+        if ( p == npos ){
+            clear_work();
+            return false;
+        }
+
+        theta = xB[p] / work[p];
+        for ( size_t r : nonzeros )
+            xB[r] = max( xB[r] - theta * work[r], 0.0 );
+        xB[p] = theta;
+        pos[head[p]] = npos;
+        head[p] = q;
+        pos[q] = p;
+        add_eta( p );
+        clear_work();
+        if ( ++updates >= refactor )
+            reinvert();
+    }
+    return false;
+}
+
+double RevisedSimplex::objective() const{
+    double z = 0.0;
+    for ( size_t r = 0; r < m; ++r )
+        if ( head[r] < cols() )
+            z += cost[head[r]] * xB[r];
+    return z;
+}
+
 //
 //
 //int main( int argc, char *argv[] ){
@@ -0,0 +1,108 @@
+#include "stats.h"
+#include "timer.h"
+#include <iostream>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <set>
+
+// The running sampler, shared with every Counters
+// live		- registered counters
+// out		- where the lines go, null while no sampler runs
+// stopping	- the sampler is being destroyed
+struct SamplerState{
+	mutex lock;
+	condition_variable wake;
+	set<const Counters *> live;
+	ostream *out;
+	unique_ptr<ofstream> file;
+	TimePoint start;
+	bool stopping;
+	thread worker;
+
+	SamplerState() : out( nullptr ), stopping( false ) {}
+
+	// Under lock
+	void line( const Counters &c, const char *tag ){
+		*out << seconds_since( start ) << ' ';
+		c.write( *out );
+		*out << tag << '\n';
+	}
+};
+
+static SamplerState &sampler(){
+	static SamplerState state;
+	return state;
+}
+
+Counters::Counters( const string &label_, const vector<string> &names_, bool sampled_ )
+	: label( label_ ), names( names_ ), values( new atomic<unsigned long long>[names_.size()] ), sampled( sampled_ ){
+	for ( size_t i = 0; i < names.size(); ++i )
+		values[i].store( 0, memory_order_relaxed );
+	if ( !sampled )
+		return;
+	SamplerState &s = sampler();
+	lock_guard<mutex> guard( s.lock );
+	if ( s.out )
+		s.live.insert( this );
+	else
+		sampled = false;
+}
+
+Counters::~Counters(){
+	if ( !sampled )
+		return;
+	SamplerState &s = sampler();
+	lock_guard<mutex> guard( s.lock );
+	if ( s.out && s.live.count( this ) ){
+		s.line( *this, " final" );
+		s.out->flush();
+	}
+	s.live.erase( this );
+}
+
+void Counters::write( ostream &os ) const {
+	os << label;
+	for ( size_t i = 0; i < names.size(); ++i )
+		os << ' ' << names[i] << '=' << get( i );
+}
+
+StatsSampler::StatsSampler( const string &path, double period ){
+	SamplerState &s = sampler();
+	lock_guard<mutex> guard( s.lock );
+	if ( path == "-" )
+		s.out = &cerr;
+	else{
+		s.file.reset( new ofstream( path ) );
+		s.out = s.file.get();
+	}
+	s.start = Clock::now();
+	s.stopping = false;
+	s.worker = thread( [&s, period](){
+		unique_lock<mutex> guard( s.lock );
+		SecondsDouble wait( period );
+		while ( !s.wake.wait_for( guard, wait, [&s](){ return s.stopping; } ) ){
+			for ( const Counters *c : s.live )
+				s.line( *c, "" );
+			s.out->flush();
+		}
+	} );
+}
+
+StatsSampler::~StatsSampler(){
+	SamplerState &s = sampler();
+	{
+		lock_guard<mutex> guard( s.lock );
+		s.stopping = true;
+	}
+	s.wake.notify_one();
+	s.worker.join();
+	lock_guard<mutex> guard( s.lock );
+	for ( const Counters *c : s.live )
+		s.line( *c, " final" );
+	s.out->flush();
+	s.live.clear();
+	s.out = nullptr;
+	s.file.reset();
+}
\ No newline at end of file
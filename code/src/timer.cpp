@@ -0,0 +1,20 @@
+#include "timer.h"
+#include <algorithm>
+
+Deadline::Deadline( TimePoint start, double seconds, const atomic<bool> *stop_ )
+	: last( Clock::now() ), stride( 1 ), count( 0 ), over( false ), stop( stop_ ){
+	// About 30 years, so that a huge cutoff does not overflow the clock
+	end = start + chrono::duration_cast<Clock::duration>( SecondsDouble( min( seconds, 1e9 ) ) );
+}
+
+bool Deadline::check(){
+	TimePoint now = Clock::now();
+	SecondsDouble gap = now - last;
+	last = now;
+	if ( gap.count() < 1e-4 && stride < ( 1u << 20 ) )
+		stride *= 2;
+	else if ( gap.count() > 1e-3 && stride > 1 )
+		stride /= 2;
+	over = now >= end;
+	return over;
+}
\ No newline at end of file
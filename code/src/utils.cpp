@@ -1,4 +1,6 @@
 #include "utils.h"
+#include <sys/types.h>
+#include <sys/stat.h>
 
 void _split( const std::string &s, char delim, std::vector<std::string> &elems ) {
 	std::stringstream ss( s );
@@ -12,4 +14,88 @@ std::vector<std::string> split( const std::string &s, char delim ) {
 	std::vector<std::string> elems;
 	_split( s, delim, elems );
 	return elems;
-}
\ No newline at end of file
+}
+
+bool file_stamp( const std::string &path, uint64_t &size, int64_t &mtime ){
+	struct stat st;
+	if ( stat( path.c_str(), &st ) != 0 )
+		return false;
+	size = st.st_size;
+	mtime = st.st_mtime;
+	return true;
+}
+
+uint64_t checksum( const void *data, size_t bytes, uint64_t h ){
+	// Four independent multiply-xor lanes so the loop is not latency bound
+	const uint64_t prime = 0x100000001b3ull;
+	const uint64_t *w = static_cast<const uint64_t *>( data );
+	size_t n = bytes / sizeof( uint64_t ), i = 0;
+	uint64_t lane[4] = { h ^ 0xcbf29ce484222325ull, h + 1, h + 2, h + 3 };
+	for ( ; i + 4 <= n; i += 4 )
+		for ( int l = 0; l < 4; ++l )
+			lane[l] = ( lane[l] ^ w[i + l] ) * prime;
+	for ( ; i < n; ++i )
+		lane[0] = ( lane[0] ^ w[i] ) * prime;
+	h = n;
+	for ( int l = 0; l < 4; ++l ){
+		h = ( h ^ lane[l] ) * prime;
+		h ^= h >> 29;
+	}
+	return h;
+}
+
+#ifdef _WIN32
+
+#include <fstream>
+
+MappedFile::MappedFile( const std::string &path ) : _data( nullptr ), _size( 0 ), _good( false ){
+	std::ifstream ifs( path, std::ios::binary | std::ios::ate );
+	if ( !ifs.good() )
+		return;
+	buffer.resize( static_cast<size_t>( ifs.tellg() ) );
+	ifs.seekg( 0 );
+	ifs.read( buffer.data(), buffer.size() );
+	_data = buffer.data();
+	_size = buffer.size();
+	_good = true;
+}
+
+MappedFile::~MappedFile(){}
+
+void MappedFile::sequential( bool ) const {}
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile( const std::string &path ) : _data( nullptr ), _size( 0 ), _good( false ){
+	int fd = open( path.c_str(), O_RDONLY );
+	if ( fd < 0 )
+		return;
+	struct stat st;
+	if ( fstat( fd, &st ) == 0 ){
+		_good = st.st_size == 0;
+		void *p = st.st_size > 0 ? mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 ) : MAP_FAILED;
+		if ( p != MAP_FAILED ){
+			_data = static_cast<const char *>( p );
+			_size = st.st_size;
+			_good = true;
+		}
+	}
+	close( fd );
+}
+
+MappedFile::~MappedFile(){
+	if ( _data != nullptr )
+		munmap( const_cast<char *>( _data ), _size );
+}
+
+void MappedFile::sequential( bool on ) const {
+	if ( _data != nullptr )
+		madvise( const_cast<char *>( _data ), _size, on ? MADV_SEQUENTIAL : MADV_NORMAL );
+}
+
+#endif